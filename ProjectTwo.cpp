@@ -16,6 +16,46 @@
 #include <iomanip>
 #include <string.h>
 #include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <cmath>
+#include <filesystem>
+#include <queue>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+// the CSV tokenizer has SSE2 and AVX2 scans on x86-64, chosen at runtime
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CSV_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// lowestSetBit uses the bit scan intrinsic on MSVC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 
 
@@ -26,6 +66,330 @@ using namespace std;
 //============================================================================
 
 
+/*
+Instrumentation for the --stats report. It is only compiled in when
+COURSE_PLANNER_STATS is defined (g++ -DCOURSE_PLANNER_STATS ...); otherwise
+every STATS_ macro expands to nothing and normal builds pay nothing
+*/
+#ifdef COURSE_PLANNER_STATS
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * Define a structure holding the counters behind the --stats report
+ * Counters are relaxed atomics since loading and lookups run on several threads
+ */
+struct PlannerStats {
+    // bucket i counts lookups that took less than 2^i nanoseconds
+    static const int HISTOGRAM_BUCKETS = 40;
+
+    atomic<uint64_t> comparisons;
+    atomic<uint64_t> allocations;
+    atomic<uint64_t> allocatedBytes;
+    atomic<uint64_t> lookupHistogram[HISTOGRAM_BUCKETS];
+
+    // tree inserts by move or emplace, and the most allocations one of them made
+    atomic<uint64_t> inserts;
+    atomic<uint64_t> insertAllocationsMax;
+
+    // wall time and counter deltas of each load phase, in order
+    struct Phase {
+        string name;
+        double ms;
+        uint64_t comparisons;
+        uint64_t allocations;
+    };
+    vector<Phase> phases;
+    chrono::steady_clock::time_point phaseStart;
+    uint64_t phaseComparisons;
+    uint64_t phaseAllocations;
+
+    void StartPhases();
+    void EndPhase(const char* name);
+    void RecordLookup(chrono::steady_clock::time_point start);
+    void RecordInsert(uint64_t allocationsBefore);
+    void Print(ostream& out);
+};
+
+// zero initialized before any allocation can happen
+PlannerStats plannerStats;
+
+// allocations made by this thread, so other threads do not disturb the count of one insert
+thread_local uint64_t threadAllocations = 0;
+
+/**
+ * Start timing the phases of a load, dropping the phases of earlier loads
+ */
+void PlannerStats::StartPhases() {
+    phases.clear();
+    phaseStart = chrono::steady_clock::now();
+    phaseComparisons = comparisons.load();
+    phaseAllocations = allocations.load();
+}
+
+/**
+ * Record the phase that ends now, it started where the previous phase ended
+ *
+ * @param name Name of the phase
+ */
+void PlannerStats::EndPhase(const char* name) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    uint64_t nowComparisons = comparisons.load();
+    uint64_t nowAllocations = allocations.load();
+    phases.push_back({ name, chrono::duration<double, milli>(now - phaseStart).count(),
+        nowComparisons - phaseComparisons, nowAllocations - phaseAllocations });
+    phaseStart = chrono::steady_clock::now();
+    phaseComparisons = nowComparisons;
+    phaseAllocations = allocations.load();
+}
+
+/**
+ * Add one lookup to the latency histogram
+ *
+ * @param start Time the lookup started
+ */
+void PlannerStats::RecordLookup(chrono::steady_clock::time_point start) {
+    uint64_t ns = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    int bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && (ns >> bucket) != 0) {
+        bucket += 1;
+    }
+    lookupHistogram[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * Record one tree insert or bulk loaded node, a moved or emplaced course
+ * should cost at most the slab allocation of its node
+ *
+ * @param allocationsBefore Allocations of this thread when the insert started
+ */
+void PlannerStats::RecordInsert(uint64_t allocationsBefore) {
+    uint64_t made = threadAllocations - allocationsBefore;
+    inserts.fetch_add(1, memory_order_relaxed);
+    uint64_t most = insertAllocationsMax.load(memory_order_relaxed);
+    while (made > most && !insertAllocationsMax.compare_exchange_weak(most, made, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Print the load phases, the counters and the lookup latency histogram
+ *
+ * @param out Stream to print to
+ */
+void PlannerStats::Print(ostream& out) {
+    out << "Load phases:" << '\n';
+    double totalMs = 0;
+    for (int i = 0; i < (int)phases.size(); i++) {
+        out << "  " << left << setw(16) << phases[i].name << right << fixed << setprecision(3) << setw(12) << phases[i].ms << " ms"
+            << setw(14) << phases[i].comparisons << " comparisons" << setw(12) << phases[i].allocations << " allocations" << '\n';
+        totalMs += phases[i].ms;
+    }
+    out << "  " << left << setw(16) << "total" << right << setw(12) << totalMs << " ms" << '\n';
+    out << "Key comparisons: " << comparisons.load() << '\n';
+    out << "Allocations: " << allocations.load() << " (" << allocatedBytes.load() << " bytes)" << '\n';
+    out << "Tree inserts: " << inserts.load() << ", most allocations in one insert: " << insertAllocationsMax.load() << '\n';
+
+    // only the buckets that were used
+    uint64_t lookups = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        lookups += lookupHistogram[i].load();
+    }
+    out << "Course lookups: " << lookups << '\n';
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        uint64_t count = lookupHistogram[i].load();
+        if (count != 0) {
+            out << "  < " << setw(12) << (1ULL << i) << " ns" << setw(12) << count << '\n';
+        }
+    }
+}
+
+// count every heap allocation the program makes
+void* operator new(size_t size) {
+    threadAllocations += 1;
+    plannerStats.allocations.fetch_add(1, memory_order_relaxed);
+    plannerStats.allocatedBytes.fetch_add(size, memory_order_relaxed);
+    void* memory = malloc((size != 0) ? size : 1);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+// GCC cannot tell these replace the global operators and warns that free does not match new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#define STATS_COUNT(counter) plannerStats.counter.fetch_add(1, memory_order_relaxed)
+#define STATS_START_PHASES() plannerStats.StartPhases()
+#define STATS_END_PHASE(name) plannerStats.EndPhase(name)
+#define STATS_TIMER(timer) chrono::steady_clock::time_point timer = chrono::steady_clock::now()
+#define STATS_RECORD_LOOKUP(timer) plannerStats.RecordLookup(timer)
+#define STATS_INSERT_BEGIN(name) uint64_t name = threadAllocations
+#define STATS_INSERT_END(name) plannerStats.RecordInsert(name)
+#define STATS_THREAD_ALLOCATIONS() threadAllocations
+
+#else
+
+#define STATS_COUNT(counter) ((void)0)
+#define STATS_START_PHASES() ((void)0)
+#define STATS_END_PHASE(name) ((void)0)
+#define STATS_TIMER(timer) ((void)0)
+#define STATS_RECORD_LOOKUP(timer) ((void)0)
+#define STATS_INSERT_BEGIN(name) ((void)0)
+#define STATS_INSERT_END(name) ((void)0)
+#define STATS_THREAD_ALLOCATIONS() ((uint64_t)0)
+
+#endif
+
+/**
+ * Define a structure holding a course ID packed into two integers
+ * The first 15 characters are uppercased and stored big endian, zero padded,
+ * so comparing the integers orders keys the same way as comparing the IDs.
+ * The last byte is 0xFF for IDs longer than 15 characters, two such keys that
+ * tie must be ordered by comparing the ID strings
+ */
+struct CourseKey {
+    uint64_t high;
+    uint64_t low;
+
+    // longest ID that is compared by its key alone
+    static const int MAX_PACKED = 15;
+
+    // default constructor, the key of an empty ID
+    CourseKey() {
+        high = 0;
+        low = 0;
+    }
+
+    // pack a course ID
+    CourseKey(string_view courseId) {
+        high = 0;
+        low = 0;
+        for (int i = 0; i < MAX_PACKED; i++) {
+            uint64_t c = (i < (int)courseId.size()) ? (unsigned char)toupper((unsigned char)courseId[i]) : 0;
+            if (i < 8) {
+                high |= c << (56 - 8 * i);
+            }
+            else {
+                low |= c << (56 - 8 * (i - 8));
+            }
+        }
+
+        // mark keys that need the string to break a tie
+        if ((int)courseId.size() > MAX_PACKED) {
+            low |= 0xFF;
+        }
+    }
+
+    // true if the ID did not fit in the key
+    bool IsOverflow() const {
+        return (low & 0xFF) == 0xFF;
+    }
+};
+
+/*
+Function for comparing two course IDs through their keys
+Only IDs longer than the key fall back to comparing the strings
+@param: key and ID of the first course, key and ID of the second course
+@return: negative, zero or positive like string::compare
+*/
+inline int compareCourseIds(const CourseKey& aKey, string_view aId, const CourseKey& bKey, string_view bId) {
+    STATS_COUNT(comparisons);
+    if (aKey.high != bKey.high) {
+        return (aKey.high < bKey.high) ? -1 : 1;
+    }
+    if (aKey.low != bKey.low) {
+        return (aKey.low < bKey.low) ? -1 : 1;
+    }
+
+    // equal keys are only ambiguous when both IDs overflowed the key
+    if (aKey.IsOverflow()) {
+        return aId.compare(bId);
+    }
+    return 0;
+}
+
+/*
+Function for laying out a sorted array in Eytzinger (BFS) order, where the
+children of slot k are at 2k and 2k + 1 and slot 0 is unused
+@param: number of sorted entries
+@return: the sorted position stored in each slot
+*/
+vector<int> eytzingerLayout(int count) {
+    vector<int> layout(count + 1, -1);
+
+    // walking the slots in order (left, self, right) visits them in sorted order
+    int next = 0;
+    int slot = 1;
+    while (next < count) {
+
+        // go as far left as possible
+        while (slot <= count) {
+            slot = 2 * slot;
+        }
+
+        // step back up past every slot we came back to from the right
+        while (slot & 1) {
+            slot >>= 1;
+        }
+        slot >>= 1;
+
+        // fill the slot, then continue in its right subtree
+        layout[slot] = next;
+        next += 1;
+        slot = 2 * slot + 1;
+    }
+    return layout;
+}
+
+/*
+Function for finding a course ID among keys laid out by eytzingerLayout
+The search is branch free, and the four grandchildren of each slot share a
+cache line that is prefetched while the slot is compared
+@param: keys by slot, number of keys, key and ID to find, function giving the ID in a slot
+@return: the slot holding the ID, or 0 when it is not there
+*/
+template<typename IdAt>
+int eytzingerFind(const CourseKey* keys, int count, const CourseKey& key, string_view courseId, IdAt idAt) {
+    int slot = 1;
+
+    // go left while the key is not smaller, the comparison result picks the child
+    while (slot <= count) {
+#if defined(__GNUC__)
+        if (4 * slot <= count) {
+            __builtin_prefetch(keys + 4 * slot);
+        }
+#endif
+        slot = 2 * slot + (compareCourseIds(keys[slot], idAt(slot), key, courseId) < 0);
+    }
+
+    // undo the right turns taken after the last left turn, that slot is the lower bound
+    while (slot & 1) {
+        slot >>= 1;
+    }
+    slot >>= 1;
+
+    // slot 0 means every key is smaller
+    if (slot != 0 && compareCourseIds(keys[slot], idAt(slot), key, courseId) == 0) {
+        return slot;
+    }
+    return 0;
+}
+
 // define a structure to hold bid information
 struct Course {
     string courseId; // unique identifier
@@ -38,554 +402,8396 @@ struct Course {
 
     // create a course by courseId
     Course(string aCourseId) {
-        courseId = aCourseId;
+        courseId = std::move(aCourseId);
     }
 
     // create a course by course Id and course name
     Course(string aCourseId, string aCourseName) {
-        courseId = aCourseId;
-        name = aCourseName;
+        courseId = std::move(aCourseId);
+        name = std::move(aCourseName);
     }
 };
 
+/*
+Function to estimate the heap memory held by a string, 0 when it fits in the string itself
+@param: text to measure
+*/
+inline size_t heapBytes(const string& text) {
+    const char* data = text.data();
+    const char* self = reinterpret_cast<const char*>(&text);
+    if (data >= self && data < self + sizeof(string)) {
+        return 0;
+    }
+    return text.capacity() + 1;
+}
+
+/*
+Function to estimate the heap memory held by a course, not counting the course itself
+@param: course to measure
+*/
+inline size_t heapBytes(const Course& course) {
+    size_t bytes = heapBytes(course.courseId) + heapBytes(course.name) + course.prereq.capacity() * sizeof(string);
+    for (int i = 0; i < (int)course.prereq.size(); i++) {
+        bytes += heapBytes(course.prereq[i]);
+    }
+    return bytes;
+}
+
+/*
+Function to find the lowest set bit of a non-zero mask, one instruction where
+the compiler has one for it
+@param: mask with at least one bit set
+*/
+inline int lowestSetBit(uint64_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanForward64(&bit, bits);
+    return (int)bit;
+#else
+    int bit = 0;
+    while (((bits >> bit) & 1) == 0) {
+        bit += 1;
+    }
+    return bit;
+#endif
+}
+
 // Internal structure for tree node
 struct Node {
+    // packed course ID, compared instead of the course ID string
+    CourseKey key;
     Course course;
     Node* left;
     Node* right;
 
+    // parent of the node (nullptr for the root), lets iterators walk the tree without a stack
+    Node* parent;
+
+    // height of the subtree rooted at this node (a leaf has height 1)
+    int height;
+
     // default constructor
     Node() {
         left = nullptr;
         right = nullptr;
+        parent = nullptr;
+        height = 1;
     }
 
-    // initialize with a bid
-    Node(Course aCourse) :
+    // initialize with a copy of a course
+    Node(const Course& aCourse) :
         Node() {
         course = aCourse;
+        key = CourseKey(course.courseId);
+    }
+
+    // initialize with a course, taking over its strings and prerequisites
+    Node(Course&& aCourse) :
+        Node() {
+        course = std::move(aCourse);
+        key = CourseKey(course.courseId);
+    }
+
+    // construct the course in place from the arguments of a Course constructor
+    template<typename... Args>
+    Node(in_place_t, Args&&... args) :
+        course(std::forward<Args>(args)...) {
+        left = nullptr;
+        right = nullptr;
+        parent = nullptr;
+        height = 1;
+        key = CourseKey(course.courseId);
     }
 };
 
 //============================================================================
-// Binary Search Tree class definition
+// Node pool class definition
 //============================================================================
 
 /**
- * Define a class containing data members and methods to
- * implement a binary search tree
+ * Define a class that hands out tree nodes from large contiguous slabs
+ * so nodes sit close together in memory and the whole tree can be freed at once
  */
-class BinarySearchTree {
+class NodePool {
 
 private:
-    Node* root;
+    // number of nodes carved out of each slab
+    static const int SLAB_SIZE = 1024;
+
+    // a slab holds its nodes after a link to the slab allocated before it,
+    // so starting a slab is a single allocation
+    struct Slab {
+        Slab* previous;
+        alignas(Node) unsigned char storage[SLAB_SIZE * sizeof(Node)];
+
+        Node* nodes() { return reinterpret_cast<Node*>(storage); }
+    };
 
-    void addNode(Node* node, Course course);
-    void inOrder(Node* node);
+    // the slab being filled, the start of the chain of every slab allocated so far
+    Slab* lastSlab;
+    size_t slabCount;
+
+    // number of nodes handed out from the last slab
+    int used;
+
+    // nodes given back with Free, linked through their left pointers
+    Node* freeList;
 
 public:
-    BinarySearchTree();
-    void Insert(Course course);
-    void printSampleSchedule();
-    void printCourseInformation(string courseId);
+    NodePool();
+    ~NodePool();
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    template<typename... Args>
+    Node* Allocate(Args&&... args);
+    void Free(Node* node);
+    void Release();
+    size_t Capacity() const;
 };
 
 /**
  * Default constructor
  */
-BinarySearchTree::BinarySearchTree() {
-    //root is equal to nullptr
-    root = nullptr;
+NodePool::NodePool() {
+    // start with no slabs, the first allocation creates one
+    lastSlab = nullptr;
+    slabCount = 0;
+    used = SLAB_SIZE;
+    freeList = nullptr;
 }
 
 /**
- * Insert a course
+ * Destructor, frees every node and slab
  */
-void BinarySearchTree::Insert(Course course) {
-
-    // if root equal to null ptr
-    if (root == nullptr) {
-
-        // Create a new node
-        root = new Node(course);
-
-    }
-
-    // else, root is not null
-    else {
-        // add Node root and bid
-        addNode(root, course);
-    }
+NodePool::~NodePool() {
+    Release();
 }
 
 /**
- * Add a course to some node (recursive)
+ * Allocate a node holding a course
+ * Only a new slab allocates, the course is copied, moved or built in place
+ * as the Node constructor the arguments select
  *
- * @param node Current node in tree
- * @param course Course to be added
+ * @param args Arguments of a Node constructor
+ * @return the new node
  */
-void BinarySearchTree::addNode(Node* node, Course course) {
-    // if node is larger then add to left
-    if (node->course.courseId.compare(course.courseId) > 0) {
-        // if no left node
-        if (node->left == nullptr) {
-            // this node becomes left
-            node->left = new Node(course);
-        }
-        // else recurse down the left node
-        else {
-            addNode(node->left, course);
-        }
+template<typename... Args>
+Node* NodePool::Allocate(Args&&... args) {
+
+    // reuse a freed node first, every slot always holds a constructed node
+    if (freeList != nullptr) {
+        Node* node = freeList;
+        freeList = node->left;
+        node->~Node();
+        return new (node) Node(std::forward<Args>(args)...);
     }
-    // else
-    else {
-        // if no right node
-        if (node->right == nullptr) {
-            // this node becomes right
-            node->right = new Node(course);
-        }
-        //else
-        else {
-            // recurse down the left node
-            addNode(node->right, course);
-        }
 
+    // start a new slab when the current one is full
+    if (used == SLAB_SIZE) {
+        Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab)));
+        slab->previous = lastSlab;
+        lastSlab = slab;
+        slabCount += 1;
+        used = 0;
     }
+
+    // construct the node in the next free slot of the slab
+    Node* node = new (lastSlab->nodes() + used) Node(std::forward<Args>(args)...);
+    used += 1;
+    return node;
 }
+
 /**
- * Partition the vector of courses into two parts, low and high
+ * Give a single node back to the pool for reuse
+ * The node is reset to an empty node so its course memory is released now
  *
- * @param courseIds Address of the vector<Bid> instance to be partitioned
- * @param begin Beginning index to partition
- * @param end Ending index to partition
+ * @param node Node allocated from this pool
  */
-int partition(vector<string>& courseIds, int begin, int end) {
-    //set low and high equal to begin and end
-    int low = begin;
-    int high = end;
-
-    // pick the middle element as pivot point
-    int midpoint = low + (high - low) / 2;
-    string pivot = courseIds[midpoint];
-
-    // Add a bid variable for temporary reassignment in loop
-    string tempVal;
-
-
-    // initialize loop exit condition
-    bool done = false;
-
-    // while not done 
-    while (!done) {
+void NodePool::Free(Node* node) {
+    node->~Node();
+    new (node) Node();
+    node->left = freeList;
+    freeList = node;
+}
 
-        // keep incrementing low index while courseIds[low] < courseIds[pivot]
-        while (courseIds[low] < pivot) {
-            low += 1;
-        }
+/**
+ * Destroy every node handed out and free all slabs in one go
+ */
+void NodePool::Release() {
 
-        // keep decrementing high index while courseIds[pivot] < courseIds[high]
-        while (pivot < courseIds[high]) {
-            high -= 1;
-        }
+    // only the last slab, the first in the chain, can be partially filled
+    int count = used;
+    while (lastSlab != nullptr) {
+        Slab* previous = lastSlab->previous;
 
-        /* If there are zero or one elements remaining,
-            all courseIds are partitioned. Return high */
-        if (low >= high) {
-            done = true;
-            return high;
+        // destroy the nodes, then give the slab back
+        for (int j = 0; j < count; j++) {
+            lastSlab->nodes()[j].~Node();
         }
-        else {
-            // else swap the low and high courseIds (built in vector method)
-            std::swap(courseIds[low], courseIds[high]);
+        ::operator delete(lastSlab);
+        lastSlab = previous;
+        count = SLAB_SIZE;
+    }
 
-            // move low and high closer ++low, --high
-            low += 1;
-            high -= 1;
-        }
+    // the pool is empty again
+    slabCount = 0;
+    used = SLAB_SIZE;
+    freeList = nullptr;
+}
 
-    }
-    return high;
+/**
+ * Number of nodes the allocated slabs can hold
+ */
+size_t NodePool::Capacity() const {
+    return slabCount * SLAB_SIZE;
 }
 
 /**
-*
- * Perform a quick sort on bid title
- * Average performance: O(n log(n))
- * Worst case performance O(n^2))
- *
- * @param courseIds address of the vector<Bid> instance to be sorted
- * @param begin the beginning index to sort on
- * @param end the ending index to sort on
+ * Run a number of tasks, each on its own thread
+ * The calling thread runs task 0 and then waits for the rest
  *
+ * @param taskCount Number of tasks to run
+ * @param task Function called with the index of each task
  */
-void quickSort(vector<string>& courseIds, int begin, int end) {
-    //set mid equal to 0
-    int mid = 0;
-
-    /* Base case: If there are 1 or zero courseIds to sort,
-     partition is already sorted otherwise if begin is greater
-     than or equal to end then return
-     */
-    if (courseIds.size() <= 1) {
-        return;
+void runParallel(int taskCount, const function<void(int)>& task) {
+    vector<thread> workers;
+    for (int i = 1; i < taskCount; i++) {
+        workers.push_back(thread(task, i));
     }
-    else if (begin >= end) {
-        return;
+    task(0);
+    for (int i = 0; i < (int)workers.size(); i++) {
+        workers[i].join();
     }
+}
 
-    /* Partition courseIds into low and high such that
-     midpoint is location of last element in low */
-    mid = partition(courseIds, begin, end);
-
-    // recursively sort low partition (begin to mid)
-    quickSort(courseIds, begin, mid);
+//============================================================================
+// Course ID index class definition
+//============================================================================
 
-    // recursively sort high partition (mid+1 to end)
-    quickSort(courseIds, mid + 1, end);
+/**
+ * Define an open addressing hash table that maps course IDs to an index
+ * Built once from the loaded IDs, lookups are O(1) on average. Uses linear
+ * probing over a power of two table that is kept at most half full
+ */
+class CourseIdIndex {
 
-}
-/*
-* BinarySearch is used to search a sorted vector for a value.
-* In this case, it will be used to search a vector of courseIDs for a prerquisite Id
-*/
-int binarySearch(vector<string> searchVector, int vectorSize, string searchId) {
+private:
+    // the IDs added, a slot refers to an ID by its position in this vector
+    vector<string> ids;
 
-    // intial values of the midpoint, low, and high indices of the search vector
-    int mid = 0;
-    int low = 0;
-    int high = vectorSize - 1;
+    // position in ids for each slot, -1 for an empty slot
+    vector<int> slots;
 
-    // keep searching as long as the high is greater than the low
-    while (high >= low) {
+    // hash of the ID in each slot, compared before the strings are
+    vector<uint64_t> slotHashes;
 
-        // set the midpoint to the average of the high and low indices
-        mid = (high + low) / 2;
+public:
+    static uint64_t hashId(string_view courseId);
+    void Build(vector<string> courseIds, int threadCount = 1);
+    int Find(string_view courseId) const;
+    int Size() const;
+};
 
-        // if the midpoint is less than the search ID
-        if (searchVector[mid] < searchId) {
+/**
+ * FNV-1a hash of a course ID
+ *
+ * @param courseId ID to hash
+ */
+uint64_t CourseIdIndex::hashId(string_view courseId) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < courseId.size(); i++) {
+        hash ^= (unsigned char)courseId[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-            // increase to low index to one above the midpoint
-            low = mid + 1;
+/**
+ * Build the index, replacing anything added before
+ * If an ID appears more than once, the first position is kept
+ * The table is cut into one region per thread. Each thread adds, in position
+ * order, the IDs whose probe starts in its region, and an ID whose probe runs
+ * off the end of its region is left for a last pass that continues the probe
+ *
+ * @param courseIds IDs to index, each maps to its position in the vector
+ * @param threadCount Number of threads to build with
+ */
+void CourseIdIndex::Build(vector<string> courseIds, int threadCount) {
+    ids = std::move(courseIds);
+    int count = (int)ids.size();
+
+    // size the table to at least twice the number of IDs
+    size_t capacity = 16;
+    while (capacity < ids.size() * 2) {
+        capacity *= 2;
+    }
+    slots.assign(capacity, -1);
+    slotHashes.assign(capacity, 0);
+    size_t mask = capacity - 1;
+
+    // small lists are not worth splitting
+    const int MIN_IDS_PER_THREAD = 1 << 16;
+    threadCount = max(1, min(threadCount, count / MIN_IDS_PER_THREAD));
+
+    // hash every ID once
+    vector<uint64_t> hashes(count);
+    runParallel(threadCount, [&](int part) {
+        int end = (int)((long long)count * (part + 1) / threadCount);
+        for (int i = (int)((long long)count * part / threadCount); i < end; i++) {
+            hashes[i] = hashId(ids[i]);
         }
+    });
 
-        // if the midpoint is above the search Id...
-        else if (searchVector[mid] > searchId) {
+    // each thread fills its own region, the first position of an ID is added first
+    vector<size_t> regionStart(threadCount + 1);
+    for (int region = 0; region <= threadCount; region++) {
+        regionStart[region] = capacity * region / threadCount;
+    }
+    vector<vector<int>> overflow(threadCount);
+    runParallel(threadCount, [&](int region) {
+        for (int i = 0; i < count; i++) {
+            size_t slot = hashes[i] & mask;
+            if (slot < regionStart[region] || slot >= regionStart[region + 1]) {
+                continue;
+            }
 
-            // decrease the high search index to one below the midpoint
-            high = mid - 1;
+            // probe until an empty slot, the same ID or the end of the region is found
+            while (slot < regionStart[region + 1] && slots[slot] != -1 && !(slotHashes[slot] == hashes[i] && ids[slots[slot]] == ids[i])) {
+                slot += 1;
+            }
+            if (slot == regionStart[region + 1]) {
+                overflow[region].push_back(i);
+            }
+            else if (slots[slot] == -1) {
+                slots[slot] = i;
+                slotHashes[slot] = hashes[i];
+            }
         }
-        else {
-
-            // return the midpoint when it is equal to the search ID
-            return mid;
+    });
+
+    // continue each probe that ran off its region into the next one, wrapping around the table
+    for (int region = 0; region < threadCount; region++) {
+        for (int i : overflow[region]) {
+            size_t slot = regionStart[region + 1] & mask;
+            while (slots[slot] != -1 && !(slotHashes[slot] == hashes[i] && ids[slots[slot]] == ids[i])) {
+                slot = (slot + 1) & mask;
+            }
+            if (slots[slot] == -1) {
+                slots[slot] = i;
+                slotHashes[slot] = hashes[i];
+            }
         }
     }
-
-    // return -1 if no match is found
-    return -1;
 }
 
 /**
- * Load a CSV file containing Courses into a container
+ * Find a course ID
  *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the courses read
+ * @param courseId ID to search for
+ * @return the position the ID was added at, or -1 if it is not in the index
  */
-void loadCourses(string csvPath, BinarySearchTree* bst) {
-    std::cout << "Loading CSV file " << csvPath << "..." << endl;
-
-    /*
-    * Define local variables used for logic, temporary placeholders and iterations:
-    */
-    // create counter to count the number of items added to a course
-    int columnCount = 0;
-
-    // courseIndex for searching for prerequisite courses
-    int courseIndex = 0;
-
-    // create a counter for number of courses loaded
-    int courseCount = 0;
-
-    // initalize course variable
-    string courseLine;
-
-    //intialize prequisite variable
-    string tempPrereq;
+int CourseIdIndex::Find(string_view courseId) const {
+    if (slots.empty()) {
+        return -1;
+    }
 
-    // intializse course Id variable to ensure uppercase course IDs (for searching logic)
-    string tempCourseId;
+    uint64_t hash = hashId(courseId);
+    size_t mask = slots.size() - 1;
+    size_t slot = hash & mask;
 
-    // create a string variable to collect the course ID from the current line of the CSV
-    string courseIdLine;
+    // an empty slot ends the probe sequence
+    while (slots[slot] != -1) {
+        if (slotHashes[slot] == hash && ids[slots[slot]] == courseId) {
+            return slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
 
-    // create a string variable to clear the rest of the line after a course ID is retrieved
-    string deleteLine;
+/**
+ * Number of IDs added to the index
+ */
+int CourseIdIndex::Size() const {
+    return (int)ids.size();
+}
 
-    // create a vector of all course IDs to ensure all prerquisites listed are courses
-    vector<string> courseIdVector;
+//============================================================================
+// Prerequisite graph class definition
+//============================================================================
 
-    /*
-    * Start file iteration by first creating a sorted vector of all course ID
-    */
-    // create input file stream object
-    ifstream inputFile;
+/**
+ * Define a class holding the prerequisites of a catalog as a graph
+ * Courses are numbered 0 to n - 1 in course ID order. The prerequisites of
+ * course c are the course numbers prereqList[prereqStart[c]] up to
+ * prereqList[prereqStart[c + 1]], so no string lookups are needed after Build
+ */
+class CourseGraph {
 
-    // open file of course information
-    inputFile.open(csvPath);
+public:
+    // ID and name of each course, pointing into the courses the graph was built from
+    vector<string_view> courseIds;
+    vector<string_view> courseNames;
 
-    // Parse through the file to enter course IDs to the vector of course IDs
-    while (!inputFile.eof()) {
-        // get the first entry of the line only
-        getline(inputFile, courseIdLine, ',');
+    // prerequisites of every course as course numbers
+    vector<int> prereqStart;
+    vector<int> prereqList;
 
-        // add the course ID the the course ID vector
-        courseIdVector.push_back(courseIdLine);
-        
-        // get the rest of the line (not used)
-        getline(inputFile, deleteLine, '\n');
+    // course number of each course ID
+    CourseIdIndex courseIndex;
 
-        // skip final iteration if end of file reached
-        if (inputFile.eof()) break;
+    void Build(const vector<const Course*>& courses);
+    int Size() const;
+    int Terms(vector<int>& term) const;
+    void printSchedule(ostream& out) const;
+};
 
+/**
+ * Build the graph from courses in course ID order
+ * Prerequisites that are not in the list are left out
+ *
+ * @param courses Courses sorted by course ID, they must outlive the graph
+ */
+void CourseGraph::Build(const vector<const Course*>& courses) {
+    int count = (int)courses.size();
+    courseIds.resize(count);
+    courseNames.resize(count);
+    prereqStart.assign(count + 1, 0);
+    prereqList.clear();
+
+    // index the IDs so each prerequisite resolves to a course number
+    vector<string> ids(count);
+    for (int i = 0; i < count; i++) {
+        ids[i] = courses[i]->courseId;
+        courseIds[i] = courses[i]->courseId;
+        courseNames[i] = courses[i]->name;
     }
+    courseIndex.Build(std::move(ids));
+
+    // resolve the prerequisites course by course
+    for (int i = 0; i < count; i++) {
+        const vector<string>& prereq = courses[i]->prereq;
+        for (int j = 0; j < (int)prereq.size(); j++) {
+            int prereqIndex = courseIndex.Find(prereq[j]);
+            if (prereqIndex != -1) {
+                prereqList.push_back(prereqIndex);
+            }
+        }
+        prereqStart[i + 1] = (int)prereqList.size();
+    }
+}
+
+/**
+ * Number of courses in the graph
+ */
+int CourseGraph::Size() const {
+    return (int)courseIds.size();
+}
+
+/**
+ * Place every course in a term with Kahn's algorithm, O(V + E)
+ * A course goes in the term after the latest of its prerequisites, so a
+ * course without prerequisites is in term 1
+ *
+ * @param term Vector that receives the term of each course, 0 for courses on a cycle
+ * @return the number of terms
+ */
+int CourseGraph::Terms(vector<int>& term) const {
+    int count = Size();
+
+    // count prerequisites per course and collect the courses that depend on each course
+    vector<int> remaining(count, 0);
+    vector<int> dependentStart(count + 1, 0);
+    for (int i = 0; i < count; i++) {
+        remaining[i] = prereqStart[i + 1] - prereqStart[i];
+        for (int j = prereqStart[i]; j < prereqStart[i + 1]; j++) {
+            dependentStart[prereqList[j] + 1] += 1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        dependentStart[i + 1] += dependentStart[i];
+    }
+    vector<int> dependentList(prereqList.size());
+    vector<int> next(dependentStart.begin(), dependentStart.end() - 1);
+    for (int i = 0; i < count; i++) {
+        for (int j = prereqStart[i]; j < prereqStart[i + 1]; j++) {
+            dependentList[next[prereqList[j]]] = i;
+            next[prereqList[j]] += 1;
+        }
+    }
+
+    // start from every course without prerequisites
+    term.assign(count, 0);
+    vector<int> queue;
+    queue.reserve(count);
+    for (int i = 0; i < count; i++) {
+        if (remaining[i] == 0) {
+            term[i] = 1;
+            queue.push_back(i);
+        }
+    }
+
+    // a course is ready once all of its prerequisites have been placed
+    int termCount = 0;
+    for (int head = 0; head < (int)queue.size(); head++) {
+        int course = queue[head];
+        termCount = max(termCount, term[course]);
+        for (int j = dependentStart[course]; j < dependentStart[course + 1]; j++) {
+            int dependent = dependentList[j];
+            term[dependent] = max(term[dependent], term[course] + 1);
+            remaining[dependent] -= 1;
+            if (remaining[dependent] == 0) {
+                queue.push_back(dependent);
+            }
+        }
+    }
+
+    // courses that never became ready are on (or behind) a cycle
+    for (int i = 0; i < count; i++) {
+        if (remaining[i] != 0) {
+            term[i] = 0;
+        }
+    }
+    return termCount;
+}
+
+/**
+ * Print a schedule that takes every course after its prerequisites,
+ * grouped by term and in course ID order within a term
+ *
+ * @param out Stream to print to
+ */
+void CourseGraph::printSchedule(ostream& out) const {
+    vector<int> term;
+    int termCount = Terms(term);
+
+    // group the courses by term, courses on a cycle are group 0
+    vector<int> groupStart(termCount + 2, 0);
+    for (int i = 0; i < Size(); i++) {
+        groupStart[term[i] + 1] += 1;
+    }
+    for (int t = 0; t <= termCount; t++) {
+        groupStart[t + 1] += groupStart[t];
+    }
+    vector<int> grouped(Size());
+    vector<int> next(groupStart.begin(), groupStart.end() - 1);
+    for (int i = 0; i < Size(); i++) {
+        grouped[next[term[i]]] = i;
+        next[term[i]] += 1;
+    }
+
+    // output each term
+    for (int t = 1; t <= termCount; t++) {
+        out << "Term " << t << ":" << '\n';
+        for (int j = groupStart[t]; j < groupStart[t + 1]; j++) {
+            out << "    " << courseIds[grouped[j]] << ", " << courseNames[grouped[j]] << '\n';
+        }
+    }
+
+    // report the courses that cannot be scheduled
+    if (groupStart[1] > 0) {
+        out << groupStart[1] << " courses could not be scheduled because of a prerequisite cycle:" << '\n';
+        for (int j = 0; j < groupStart[1]; j++) {
+            out << "    " << courseIds[grouped[j]] << ", " << courseNames[grouped[j]] << '\n';
+        }
+    }
+    out << flush;
+}
+
+//============================================================================
+// Prerequisite closure class definition
+//============================================================================
+
+/**
+ * Define a class that precomputes every course required before each course
+ * The prerequisite graph is split into connected components, and each course
+ * gets a bitset over the courses of its own component, so memory grows with
+ * the square of the component size rather than of the catalog. Components
+ * that would go over the memory budget, or that contain a cycle, are answered
+ * by a search of the graph instead. Rebuilding reuses the bitsets of every
+ * component whose courses and prerequisites did not change
+ */
+class PrerequisiteClosure {
+
+private:
+    // closure of one connected component of the graph
+    struct Component {
+        // hash of the IDs and prerequisites of the courses in the component
+        uint64_t signature;
+        int size;
+        int edges;
+
+        // false when queries must search the graph instead
+        bool cached;
+
+        // one row of words per course, bit j set when local course j is required first
+        int words;
+        vector<uint64_t> bits;
+    };
+
+    const CourseGraph* graph;
+
+    // component of each course and the position of the course within it
+    vector<int> componentOf;
+    vector<int> localIndex;
+
+    // courses of each component in course number order
+    vector<int> memberStart;
+    vector<int> memberList;
+
+    vector<shared_ptr<Component>> components;
+
+    // total bytes the bitsets may use
+    size_t memoryBudget;
+
+    void search(int course, int stopAt, vector<int>* found) const;
+
+public:
+    PrerequisiteClosure(size_t budget = 64 << 20);
+    void Build(const CourseGraph& aGraph);
+    vector<int> AllPrerequisites(int course) const;
+    bool IsPrerequisiteOf(int prereq, int course) const;
+};
+
+/**
+ * Default constructor
+ *
+ * @param budget Bytes the bitsets may use in total
+ */
+PrerequisiteClosure::PrerequisiteClosure(size_t budget) {
+    graph = nullptr;
+    memoryBudget = budget;
+}
+
+/**
+ * Build the closure of a graph
+ * Components that are unchanged since the last Build keep their bitsets
+ *
+ * @param aGraph Graph to build from, it must outlive the closure
+ */
+void PrerequisiteClosure::Build(const CourseGraph& aGraph) {
+    graph = &aGraph;
+    int count = graph->Size();
+
+    // join every course with its prerequisites (union find with path halving)
+    vector<int> parent(count);
+    for (int i = 0; i < count; i++) {
+        parent[i] = i;
+    }
+    auto findRoot = [&](int course) {
+        while (parent[course] != course) {
+            parent[course] = parent[parent[course]];
+            course = parent[course];
+        }
+        return course;
+    };
+    for (int i = 0; i < count; i++) {
+        for (int j = graph->prereqStart[i]; j < graph->prereqStart[i + 1]; j++) {
+            int a = findRoot(i);
+            int b = findRoot(graph->prereqList[j]);
+            if (a != b) {
+                parent[max(a, b)] = min(a, b);
+            }
+        }
+    }
+
+    // number the components and list their courses in course number order
+    componentOf.assign(count, -1);
+    localIndex.assign(count, 0);
+    vector<int> componentSize;
+    for (int i = 0; i < count; i++) {
+        int root = findRoot(i);
+        if (componentOf[root] == -1) {
+            componentOf[root] = (int)componentSize.size();
+            componentSize.push_back(0);
+        }
+        componentOf[i] = componentOf[root];
+        localIndex[i] = componentSize[componentOf[i]];
+        componentSize[componentOf[i]] += 1;
+    }
+    int componentCount = (int)componentSize.size();
+    memberStart.assign(componentCount + 1, 0);
+    for (int c = 0; c < componentCount; c++) {
+        memberStart[c + 1] = memberStart[c] + componentSize[c];
+    }
+    memberList.resize(count);
+    for (int i = 0; i < count; i++) {
+        memberList[memberStart[componentOf[i]] + localIndex[i]] = i;
+    }
+
+    // terms give an order in which prerequisites come first, 0 marks a cycle
+    vector<int> term;
+    graph->Terms(term);
+
+    // keep the previous components so unchanged ones can be reused
+    unordered_map<uint64_t, shared_ptr<Component>> previous;
+    for (int c = 0; c < (int)components.size(); c++) {
+        if (components[c]->cached && components[c]->size > 1) {
+            previous[components[c]->signature] = components[c];
+        }
+    }
+    components.assign(componentCount, nullptr);
+
+    size_t used = 0;
+    for (int c = 0; c < componentCount; c++) {
+        shared_ptr<Component> component = make_shared<Component>();
+        component->size = componentSize[c];
+        component->edges = 0;
+        component->cached = true;
+
+        // hash the IDs and prerequisites, prerequisites by their position in the component
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        };
+        for (int m = memberStart[c]; m < memberStart[c + 1]; m++) {
+            int course = memberList[m];
+            string_view id = graph->courseIds[course];
+            for (size_t k = 0; k < id.size(); k++) {
+                mix((unsigned char)id[k]);
+            }
+            mix(0x100);
+            for (int j = graph->prereqStart[course]; j < graph->prereqStart[course + 1]; j++) {
+                mix(0x200 + localIndex[graph->prereqList[j]]);
+                component->edges += 1;
+            }
+            if (term[course] == 0) {
+                component->cached = false;
+            }
+        }
+        component->signature = hash;
+
+        // reuse the bitsets of an identical component from the last build
+        auto match = previous.find(hash);
+        if (match != previous.end() && match->second->size == component->size && match->second->edges == component->edges) {
+            components[c] = match->second;
+            used += match->second->bits.size() * sizeof(uint64_t);
+            continue;
+        }
+
+        // a single course without prerequisites needs no bitset
+        component->words = (component->size + 63) / 64;
+        size_t bytes = (component->size > 1) ? (size_t)component->size * component->words * sizeof(uint64_t) : 0;
+        if (!component->cached || used + bytes > memoryBudget) {
+            component->cached = false;
+            components[c] = component;
+            continue;
+        }
+        used += bytes;
+        component->bits.assign(bytes / sizeof(uint64_t), 0);
+
+        // visit the courses by term so every prerequisite row is final before it is used
+        vector<int> order(memberList.begin() + memberStart[c], memberList.begin() + memberStart[c + 1]);
+        stable_sort(order.begin(), order.end(), [&term](int a, int b) {
+            return term[a] < term[b];
+        });
+        for (int m = 0; m < (int)order.size(); m++) {
+            int course = order[m];
+            uint64_t* row = component->bits.data() + (size_t)localIndex[course] * component->words;
+            for (int j = graph->prereqStart[course]; j < graph->prereqStart[course + 1]; j++) {
+                int prereq = graph->prereqList[j];
+                const uint64_t* prereqRow = component->bits.data() + (size_t)localIndex[prereq] * component->words;
+                for (int w = 0; w < component->words; w++) {
+                    row[w] |= prereqRow[w];
+                }
+                row[localIndex[prereq] / 64] |= 1ULL << (localIndex[prereq] % 64);
+            }
+        }
+        components[c] = component;
+    }
+}
+
+/**
+ * Search the graph from a course for its prerequisites, used for
+ * components without bitsets
+ *
+ * @param course Course to start from
+ * @param stopAt Course that ends the search when reached, -1 to search everything
+ * @param found Vector that receives every course reached, or nullptr
+ */
+void PrerequisiteClosure::search(int course, int stopAt, vector<int>* found) const {
+    int component = componentOf[course];
+    vector<bool> visited(memberStart[component + 1] - memberStart[component], false);
+    vector<int> stack(1, course);
+    while (!stack.empty()) {
+        int current = stack.back();
+        stack.pop_back();
+        for (int j = graph->prereqStart[current]; j < graph->prereqStart[current + 1]; j++) {
+            int prereq = graph->prereqList[j];
+            if (visited[localIndex[prereq]]) {
+                continue;
+            }
+            visited[localIndex[prereq]] = true;
+            if (found != nullptr) {
+                found->push_back(prereq);
+            }
+            if (prereq == stopAt) {
+                return;
+            }
+            stack.push_back(prereq);
+        }
+    }
+}
+
+/**
+ * Every course required before a course, directly or through other prerequisites
+ * O(words + k) for components with bitsets
+ *
+ * @param course Course number
+ * @return course numbers of the prerequisites in course ID order
+ */
+vector<int> PrerequisiteClosure::AllPrerequisites(int course) const {
+    vector<int> result;
+    const Component& component = *components[componentOf[course]];
+
+    // fall back to a search when the component has no bitsets
+    if (!component.cached) {
+        search(course, -1, &result);
+        sort(result.begin(), result.end());
+        return result;
+    }
+    if (component.bits.empty()) {
+        return result;
+    }
+
+    // every set bit is the position of a prerequisite within the component
+    const uint64_t* row = component.bits.data() + (size_t)localIndex[course] * component.words;
+    int first = memberStart[componentOf[course]];
+    for (int w = 0; w < component.words; w++) {
+        uint64_t word = row[w];
+        while (word != 0) {
+            result.push_back(memberList[first + w * 64 + lowestSetBit(word)]);
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
+/**
+ * Check if one course must be taken, directly or indirectly, before another
+ * O(1) for components with bitsets
+ *
+ * @param prereq Course number of the possible prerequisite
+ * @param course Course number of the later course
+ */
+bool PrerequisiteClosure::IsPrerequisiteOf(int prereq, int course) const {
+    // courses in different components never depend on each other
+    if (componentOf[prereq] != componentOf[course]) {
+        return false;
+    }
+    const Component& component = *components[componentOf[course]];
+
+    // fall back to a search when the component has no bitsets
+    if (!component.cached) {
+        vector<int> found;
+        search(course, prereq, &found);
+        return !found.empty() && found.back() == prereq;
+    }
+    if (component.bits.empty()) {
+        return false;
+    }
+    int bit = localIndex[prereq];
+    return (component.bits[(size_t)localIndex[course] * component.words + bit / 64] >> (bit % 64)) & 1;
+}
+
+//============================================================================
+// Course name index class definition
+//============================================================================
+
+/**
+ * Define a class that finds courses by words of their names
+ *
+ * Every name is lowercased and split into trigrams (each run of three
+ * characters). Each trigram has a posting list of the course numbers whose
+ * name contains it, in ascending order. A query term of three or more
+ * characters narrows the courses to the intersection of the lists of its
+ * trigrams; the few courses left are then checked for the whole term, since
+ * sharing every trigram does not make the term a substring.
+ */
+class CourseNameIndex {
+
+private:
+    int courseCount;
+
+    // lowercased names back to back, name i from nameStart[i] to nameStart[i + 1]
+    string names;
+    vector<size_t> nameStart;
+
+    // posting list of trigram slot t is postingList[postingStart[t] .. postingStart[t + 1])
+    unordered_map<uint32_t, int> trigramSlot;
+    vector<int> postingStart;
+    vector<int> postingList;
+
+    static uint32_t trigram(const char* text);
+    bool contains(int course, const string& term) const;
+
+public:
+    CourseNameIndex();
+    void Build(const CourseGraph& graph);
+    vector<int> Search(string query) const;
+};
+
+/**
+ * Default constructor
+ */
+CourseNameIndex::CourseNameIndex() {
+    courseCount = 0;
+}
+
+/**
+ * Trigram starting at a character, packed into an integer
+ */
+uint32_t CourseNameIndex::trigram(const char* text) {
+    return ((uint32_t)(unsigned char)text[0] << 16) | ((uint32_t)(unsigned char)text[1] << 8) | (unsigned char)text[2];
+}
+
+/**
+ * Build the index over the names of a graph's courses
+ *
+ * @param graph Prerequisite graph of the catalog, its course numbers are used in the posting lists
+ */
+void CourseNameIndex::Build(const CourseGraph& graph) {
+    courseCount = graph.Size();
+
+    // keep a lowercased copy of every name
+    names.clear();
+    nameStart.assign(1, 0);
+    for (int i = 0; i < courseCount; i++) {
+        for (int j = 0; j < (int)graph.courseNames[i].size(); j++) {
+            names.push_back((char)tolower((unsigned char)graph.courseNames[i][j]));
+        }
+        nameStart.push_back(names.size());
+    }
+
+    // count the courses holding each trigram, a trigram repeated in one name counts once
+    trigramSlot.clear();
+    vector<int> count;
+    vector<int> lastCourse;
+    for (int i = 0; i < courseCount; i++) {
+        for (size_t j = nameStart[i]; j + 3 <= nameStart[i + 1]; j++) {
+            auto inserted = trigramSlot.emplace(trigram(names.data() + j), (int)count.size());
+            int slot = inserted.first->second;
+            if (inserted.second) {
+                count.push_back(0);
+                lastCourse.push_back(-1);
+            }
+            if (lastCourse[slot] != i) {
+                lastCourse[slot] = i;
+                count[slot] += 1;
+            }
+        }
+    }
+
+    // lay the lists out back to back, then fill them in course order so each list is sorted
+    int slots = (int)count.size();
+    postingStart.assign(slots + 1, 0);
+    for (int t = 0; t < slots; t++) {
+        postingStart[t + 1] = postingStart[t] + count[t];
+    }
+    postingList.assign(postingStart[slots], 0);
+    vector<int> next(postingStart.begin(), postingStart.end() - 1);
+    lastCourse.assign(slots, -1);
+    for (int i = 0; i < courseCount; i++) {
+        for (size_t j = nameStart[i]; j + 3 <= nameStart[i + 1]; j++) {
+            int slot = trigramSlot.find(trigram(names.data() + j))->second;
+            if (lastCourse[slot] != i) {
+                lastCourse[slot] = i;
+                postingList[next[slot]++] = i;
+            }
+        }
+    }
+}
+
+/**
+ * Check if the name of a course holds a lowercase term
+ */
+bool CourseNameIndex::contains(int course, const string& term) const {
+    string_view name(names.data() + nameStart[course], nameStart[course + 1] - nameStart[course]);
+    return name.find(term) != string_view::npos;
+}
+
+/**
+ * Find every course whose name holds each word of a query, ignoring case
+ *
+ * @param query Words separated by spaces, each matched anywhere in the name
+ * @return the course numbers in ascending order, so in course ID order
+ */
+vector<int> CourseNameIndex::Search(string query) const {
+    vector<int> result;
+
+    // lowercase the query and split it into terms
+    transform(query.begin(), query.end(), query.begin(), [](unsigned char c) {
+        return (char)tolower(c);
+    });
+    vector<string> terms;
+    stringstream stream(query);
+    string term;
+    while (stream >> term) {
+        terms.push_back(term);
+    }
+    if (terms.empty()) {
+        return result;
+    }
+
+    // the posting list of every trigram of every term, a missing trigram means no match
+    vector<pair<const int*, const int*>> lists;
+    for (int i = 0; i < (int)terms.size(); i++) {
+        for (size_t j = 0; j + 3 <= terms[i].size(); j++) {
+            auto found = trigramSlot.find(trigram(terms[i].data() + j));
+            if (found == trigramSlot.end()) {
+                return result;
+            }
+            lists.push_back(make_pair(postingList.data() + postingStart[found->second], postingList.data() + postingStart[found->second + 1]));
+        }
+    }
+
+    // start from the shortest list and narrow it by each of the others
+    vector<int> candidates;
+    if (lists.empty()) {
+        // every term is shorter than a trigram, so every course is a candidate
+        candidates.resize(courseCount);
+        for (int i = 0; i < courseCount; i++) {
+            candidates[i] = i;
+        }
+    }
+    else {
+        sort(lists.begin(), lists.end(), [](const pair<const int*, const int*>& a, const pair<const int*, const int*>& b) {
+            return a.second - a.first < b.second - b.first;
+        });
+        candidates.assign(lists[0].first, lists[0].second);
+        for (int i = 1; i < (int)lists.size() && !candidates.empty(); i++) {
+
+            // gallop through the longer list: double the step until it passes
+            // the candidate, then binary search the last step
+            const int* position = lists[i].first;
+            const int* last = lists[i].second;
+            int kept = 0;
+            for (int j = 0; j < (int)candidates.size(); j++) {
+                ptrdiff_t step = 1;
+                while (step < last - position && position[step] < candidates[j]) {
+                    step *= 2;
+                }
+                position = std::lower_bound(position, position + min(step + 1, last - position), candidates[j]);
+                if (position == last) {
+                    break;
+                }
+                if (*position == candidates[j]) {
+                    candidates[kept++] = candidates[j];
+                }
+            }
+            candidates.resize(kept);
+        }
+    }
+
+    // keep the courses that hold every whole term
+    for (int i = 0; i < (int)candidates.size(); i++) {
+        bool matches = true;
+        for (int j = 0; j < (int)terms.size() && matches; j++) {
+            matches = contains(candidates[i], terms[j]);
+        }
+        if (matches) {
+            result.push_back(candidates[i]);
+        }
+    }
+    return result;
+}
+
+//============================================================================
+// Binary Search Tree class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a binary search tree
+ */
+class BinarySearchTree {
+
+private:
+    Node* root;
+
+    // number of courses in the tree
+    int size;
+
+    // every node of the tree is allocated from this pool
+    NodePool pool;
+
+    // when true, Insert keeps the tree AVL balanced (height stays O(log n))
+    bool balanced;
+
+    Node* addNode(Node* node, Node* newNode, bool& added);
+    bool linkNode(Node* newNode);
+    Node* removeNode(Node* node, const CourseKey& key, const string& courseId, bool& removed);
+    Node* removeLeftmost(Node* node, Node*& leftmost);
+    Node* rebalanceAfterChange(Node* node);
+    Node* lowerBoundNode(const string& courseId, bool inclusive);
+    int nodeHeight(Node* node);
+    void updateHeight(Node* node);
+    Node* rotateLeft(Node* node);
+    Node* rotateRight(Node* node);
+    Node* rebalance(Node* node);
+    Node* buildSubtree(vector<Course>& courses, int begin, int end);
+    Node* findNode(const string& courseId);
+    void collectInOrder(vector<Node*>& nodes);
+    void thaw();
+
+    // read-only lookup index built by Freeze, laid out in Eytzinger (BFS) order.
+    // Slot 0 is unused, the children of slot k are at 2k and 2k + 1
+    bool frozen;
+    vector<CourseKey> frozenKeys;
+    vector<Node*> frozenNodes;
+
+public:
+    /**
+     * Bidirectional iterator over the courses in course ID order
+     * Moves through parent pointers, so walking the whole tree needs no
+     * recursion or stack and each step is O(1) amortized
+     */
+    class iterator {
+
+    private:
+        Node* node;
+        const BinarySearchTree* tree;
+
+    public:
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Course value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const Course* pointer;
+        typedef const Course& reference;
+
+        iterator(Node* aNode = nullptr, const BinarySearchTree* aTree = nullptr);
+        reference operator*() const;
+        pointer operator->() const;
+        iterator& operator++();
+        iterator operator++(int);
+        iterator& operator--();
+        iterator operator--(int);
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+    };
+
+    BinarySearchTree(bool isBalanced = true);
+    ~BinarySearchTree();
+    BinarySearchTree(const BinarySearchTree&) = delete;
+    BinarySearchTree& operator=(const BinarySearchTree&) = delete;
+    void Clear();
+    bool Insert(const Course& course);
+    bool Insert(Course&& course);
+    template<typename... Args>
+    bool Emplace(Args&&... args);
+    bool Remove(string courseId);
+    bool Upsert(Course course);
+    int Size() const;
+    const Course* Find(string courseId);
+    size_t MemoryUsage() const;
+    void BuildFromSorted(vector<Course>& courses);
+    void Freeze();
+    int Height();
+    iterator begin() const;
+    iterator end() const;
+    iterator lower_bound(string courseId);
+    iterator upper_bound(string courseId);
+    void printStats(ostream& out = cout);
+};
+
+/**
+ * Default constructor
+ *
+ * @param isBalanced true (default) to keep the tree AVL balanced on insert,
+ *                   false for plain unbalanced insertion
+ */
+BinarySearchTree::BinarySearchTree(bool isBalanced) {
+    //root is equal to nullptr
+    root = nullptr;
+    size = 0;
+
+    // remember which insertion mode to use
+    balanced = isBalanced;
+
+    // lookups walk the tree until Freeze is called
+    frozen = false;
+}
+
+/**
+ * Destructor, frees every node in the tree
+ */
+BinarySearchTree::~BinarySearchTree() {
+    Clear();
+}
+
+/**
+ * Remove every course from the tree
+ * All nodes are released together through the node pool
+ */
+void BinarySearchTree::Clear() {
+    thaw();
+    root = nullptr;
+    size = 0;
+    pool.Release();
+}
+
+/**
+ * Insert a copy of a course
+ *
+ * @return false if a course with the same ID is already in the tree
+ */
+bool BinarySearchTree::Insert(const Course& course) {
+    return linkNode(pool.Allocate(course));
+}
+
+/**
+ * Insert a course, moving its strings and prerequisites into the new node
+ * Makes no allocation beyond the node itself
+ *
+ * @return false if a course with the same ID is already in the tree
+ */
+bool BinarySearchTree::Insert(Course&& course) {
+    STATS_INSERT_BEGIN(allocationsBefore);
+    bool added = linkNode(pool.Allocate(std::move(course)));
+    STATS_INSERT_END(allocationsBefore);
+    return added;
+}
+
+/**
+ * Insert a course built in place from the arguments of a Course constructor,
+ * such as Emplace(courseId, name)
+ *
+ * @return false if a course with the same ID is already in the tree
+ */
+template<typename... Args>
+bool BinarySearchTree::Emplace(Args&&... args) {
+    STATS_INSERT_BEGIN(allocationsBefore);
+    bool added = linkNode(pool.Allocate(in_place, std::forward<Args>(args)...));
+    STATS_INSERT_END(allocationsBefore);
+    return added;
+}
+
+/**
+ * Link a new node into the tree
+ * The first course of an ID is kept, a node with an ID already in the tree is freed
+ *
+ * @param newNode Node holding the course, not yet in the tree
+ * @return false if the ID was already in the tree
+ */
+bool BinarySearchTree::linkNode(Node* newNode) {
+
+    // the lookup index no longer matches the tree
+    thaw();
+
+    // if root equal to null ptr
+    if (root == nullptr) {
+
+        // the new node is the root
+        root = newNode;
+
+    }
+
+    // else, root is not null
+    else {
+        // add the node below the root, the root may change after rebalancing
+        bool added = true;
+        root = addNode(root, newNode, added);
+        root->parent = nullptr;
+        if (!added) {
+            pool.Free(newNode);
+            return false;
+        }
+    }
+    size += 1;
+    return true;
+}
+
+/**
+ * Remove a course
+ *
+ * @param courseId ID of the course to remove
+ * @return true if a course was removed
+ */
+bool BinarySearchTree::Remove(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    bool removed = false;
+    root = removeNode(root, CourseKey(courseId), courseId, removed);
+    if (root != nullptr) {
+        root->parent = nullptr;
+    }
+
+    // the indexes no longer match the tree
+    if (removed) {
+        thaw();
+        size -= 1;
+    }
+    return removed;
+}
+
+/**
+ * Remove a course from some node (recursive)
+ * A node with two children takes over the course of its successor, and the
+ * successor node is removed instead
+ *
+ * @param node Current node in tree
+ * @param key Packed ID of the course to remove
+ * @param courseId ID of the course to remove
+ * @param removed Set to true when a course was removed
+ * @return the root of the subtree after the course was removed
+ */
+Node* BinarySearchTree::removeNode(Node* node, const CourseKey& key, const string& courseId, bool& removed) {
+    // reached the bottom of the tree, the course is not here
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    int result = compareCourseIds(node->key, node->course.courseId, key, courseId);
+
+    // if node is larger then remove from left
+    if (result > 0) {
+        node->left = removeNode(node->left, key, courseId, removed);
+    }
+    // if node is smaller then remove from right
+    else if (result < 0) {
+        node->right = removeNode(node->right, key, courseId, removed);
+    }
+
+    // this is the node, with at most one child it is replaced by that child
+    else if (node->left == nullptr || node->right == nullptr) {
+        Node* child = (node->left != nullptr) ? node->left : node->right;
+        pool.Free(node);
+        removed = true;
+        return child;
+    }
+
+    // else take the course of the successor and remove the successor node
+    else {
+        Node* successor = nullptr;
+        node->right = removeLeftmost(node->right, successor);
+        node->course = std::move(successor->course);
+        node->key = successor->key;
+        pool.Free(successor);
+        removed = true;
+    }
+
+    return rebalanceAfterChange(node);
+}
+
+/**
+ * Unlink the leftmost node of a subtree (recursive)
+ *
+ * @param node Root of the subtree
+ * @param leftmost Set to the unlinked node, the caller frees it
+ * @return the root of the subtree after the node was unlinked
+ */
+Node* BinarySearchTree::removeLeftmost(Node* node, Node*& leftmost) {
+    // no left child, this node is the leftmost and its right child takes its place
+    if (node->left == nullptr) {
+        leftmost = node;
+        return node->right;
+    }
+
+    node->left = removeLeftmost(node->left, leftmost);
+    return rebalanceAfterChange(node);
+}
+
+/**
+ * Fix the parent pointers, height and balance of a node after one of its
+ * subtrees changed
+ *
+ * @param node Node whose subtree changed
+ * @return the root of the subtree after rebalancing
+ */
+Node* BinarySearchTree::rebalanceAfterChange(Node* node) {
+    // the children may have changed
+    if (node->left != nullptr) {
+        node->left->parent = node;
+    }
+    if (node->right != nullptr) {
+        node->right->parent = node;
+    }
+
+    // unbalanced mode only keeps the height current
+    if (!balanced) {
+        updateHeight(node);
+        return node;
+    }
+
+    // rebalance on the way back up
+    return rebalance(node);
+}
+
+/**
+ * Update a course in place, or insert it if its ID is not in the tree
+ *
+ * @param course Course to store
+ * @return true if the course was inserted, false if an existing course was updated
+ */
+bool BinarySearchTree::Upsert(Course course) {
+    transform(course.courseId.begin(), course.courseId.end(), course.courseId.begin(), ::toupper);
+
+    // replace the name and prerequisites of an existing course
+    Node* node = findNode(course.courseId);
+    if (node != nullptr) {
+        thaw();
+        node->course.name = std::move(course.name);
+        node->course.prereq = std::move(course.prereq);
+        return false;
+    }
+
+    Insert(std::move(course));
+    return true;
+}
+
+/**
+ * Number of courses in the tree
+ */
+int BinarySearchTree::Size() const {
+    return size;
+}
+
+/**
+ * Bulk load courses that are already sorted by course ID
+ * Builds a minimum height tree in O(n), instead of n inserts
+ * If the tree already holds courses, the courses are inserted one at a time
+ * Either way only the first course of each ID is kept
+ *
+ * @param courses Courses sorted by course ID (left empty afterwards)
+ */
+void BinarySearchTree::BuildFromSorted(vector<Course>& courses) {
+
+    // the lookup index no longer matches the tree
+    thaw();
+
+    // merging into an existing tree needs the normal insert path
+    if (root != nullptr) {
+        for (int i = 0; i < (int)courses.size(); i++) {
+            Insert(std::move(courses[i]));
+        }
+    }
+
+    // else build the whole tree from the middle out
+    else {
+        courses.erase(unique(courses.begin(), courses.end(), [](const Course& a, const Course& b) {
+            return a.courseId == b.courseId;
+        }), courses.end());
+        root = buildSubtree(courses, 0, (int)courses.size() - 1);
+        size = (int)courses.size();
+    }
+
+    // the courses now live in the tree
+    courses.clear();
+}
+
+/**
+ * Build a balanced subtree from a sorted range of courses (recursive)
+ * The middle course becomes the subtree root, so the depth is O(log n)
+ *
+ * @param courses Courses sorted by course ID
+ * @param begin First index of the range
+ * @param end Last index of the range
+ * @return the root of the new subtree
+ */
+Node* BinarySearchTree::buildSubtree(vector<Course>& courses, int begin, int end) {
+    // empty range, nothing to build
+    if (begin > end) {
+        return nullptr;
+    }
+
+    // the middle course becomes the root of this subtree
+    int mid = begin + (end - begin) / 2;
+    STATS_INSERT_BEGIN(allocationsBefore);
+    Node* node = pool.Allocate(std::move(courses[mid]));
+    STATS_INSERT_END(allocationsBefore);
+
+    // build both halves and set the height from them
+    node->left = buildSubtree(courses, begin, mid - 1);
+    node->right = buildSubtree(courses, mid + 1, end);
+    if (node->left != nullptr) {
+        node->left->parent = node;
+    }
+    if (node->right != nullptr) {
+        node->right->parent = node;
+    }
+    updateHeight(node);
+
+    return node;
+}
+
+/**
+ * Build a read-only copy of the keys in Eytzinger order for lookups
+ * The first levels of the search share a few cache lines and the next levels
+ * are prefetched, instead of chasing left/right pointers across the heap.
+ * Any later change to the tree drops the index again
+ */
+void BinarySearchTree::Freeze() {
+    thaw();
+
+    // collect the nodes in order
+    vector<Node*> sorted;
+    collectInOrder(sorted);
+
+    // slot 0 is unused so that children are simply 2k and 2k + 1
+    int count = (int)sorted.size();
+    vector<int> layout = eytzingerLayout(count);
+    frozenKeys.resize(count + 1);
+    frozenNodes.resize(count + 1, nullptr);
+    for (int slot = 1; slot <= count; slot++) {
+        frozenKeys[slot] = sorted[layout[slot]]->key;
+        frozenNodes[slot] = sorted[layout[slot]];
+    }
+
+    frozen = true;
+}
+
+/**
+ * Collect every node in course ID order without recursion
+ *
+ * @param nodes Vector that receives the nodes
+ */
+void BinarySearchTree::collectInOrder(vector<Node*>& nodes) {
+    vector<Node*> stack;
+    Node* node = root;
+    while (node != nullptr || !stack.empty()) {
+
+        // go as far left as possible
+        while (node != nullptr) {
+            stack.push_back(node);
+            node = node->left;
+        }
+
+        // visit the node, then its right subtree
+        node = stack.back();
+        stack.pop_back();
+        nodes.push_back(node);
+        node = node->right;
+    }
+}
+
+/**
+ * Drop the frozen lookup index, lookups walk the tree again
+ */
+void BinarySearchTree::thaw() {
+    frozen = false;
+    frozenKeys.clear();
+    frozenNodes.clear();
+}
+
+/**
+ * Find the node holding a course ID
+ *
+ * @param courseId Uppercase course ID to find
+ * @return the node, or nullptr when the course is not in the tree
+ */
+Node* BinarySearchTree::findNode(const string& courseId) {
+
+    // pack the ID once, every level compares keys
+    CourseKey key(courseId);
+
+    // search the frozen index when there is one
+    if (frozen) {
+        int slot = eytzingerFind(frozenKeys.data(), (int)frozenKeys.size() - 1, key, courseId, [this](int at) {
+            return string_view(frozenNodes[at]->course.courseId);
+        });
+        return (slot != 0) ? frozenNodes[slot] : nullptr;
+    }
+
+    // set current node equal to root
+    Node* curNode = root;
+
+    // keep looping downwards until bottom reached or matching course Id found
+    while (curNode != nullptr) {
+
+        // if match found, return current node
+        int result = compareCourseIds(curNode->key, curNode->course.courseId, key, courseId);
+        if (result == 0) {
+            return curNode;
+        }
+
+        // if course is smaller than current node then traverse left
+        if (result > 0) {
+            curNode = curNode->left;
+        }
+        // else larger so traverse right
+        else {
+            curNode = curNode->right;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Iterator constructor
+ *
+ * @param aNode Node the iterator points at, nullptr for end()
+ * @param aTree Tree being iterated, used to step back from end()
+ */
+BinarySearchTree::iterator::iterator(Node* aNode, const BinarySearchTree* aTree) {
+    node = aNode;
+    tree = aTree;
+}
+
+/**
+ * Course the iterator points at
+ */
+const Course& BinarySearchTree::iterator::operator*() const {
+    return node->course;
+}
+
+/**
+ * Member access to the course the iterator points at
+ */
+const Course* BinarySearchTree::iterator::operator->() const {
+    return &node->course;
+}
+
+/**
+ * Step to the next course in order
+ */
+BinarySearchTree::iterator& BinarySearchTree::iterator::operator++() {
+
+    // the next course is the leftmost course of the right subtree
+    if (node->right != nullptr) {
+        node = node->right;
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+    }
+
+    // else climb until we come up from a left child
+    else {
+        Node* child = node;
+        node = node->parent;
+        while (node != nullptr && child == node->right) {
+            child = node;
+            node = node->parent;
+        }
+    }
+    return *this;
+}
+
+/**
+ * Step to the next course in order, returning the old position
+ */
+BinarySearchTree::iterator BinarySearchTree::iterator::operator++(int) {
+    iterator old = *this;
+    ++(*this);
+    return old;
+}
+
+/**
+ * Step to the previous course in order, end() steps to the last course
+ */
+BinarySearchTree::iterator& BinarySearchTree::iterator::operator--() {
+
+    // from end() go to the rightmost course
+    if (node == nullptr) {
+        node = tree->root;
+        while (node != nullptr && node->right != nullptr) {
+            node = node->right;
+        }
+    }
+
+    // the previous course is the rightmost course of the left subtree
+    else if (node->left != nullptr) {
+        node = node->left;
+        while (node->right != nullptr) {
+            node = node->right;
+        }
+    }
+
+    // else climb until we come up from a right child
+    else {
+        Node* child = node;
+        node = node->parent;
+        while (node != nullptr && child == node->left) {
+            child = node;
+            node = node->parent;
+        }
+    }
+    return *this;
+}
+
+/**
+ * Step to the previous course in order, returning the old position
+ */
+BinarySearchTree::iterator BinarySearchTree::iterator::operator--(int) {
+    iterator old = *this;
+    --(*this);
+    return old;
+}
+
+/**
+ * Check if two iterators point at the same course
+ */
+bool BinarySearchTree::iterator::operator==(const iterator& other) const {
+    return node == other.node;
+}
+
+/**
+ * Check if two iterators point at different courses
+ */
+bool BinarySearchTree::iterator::operator!=(const iterator& other) const {
+    return node != other.node;
+}
+
+/**
+ * Iterator to the first course in order
+ */
+BinarySearchTree::iterator BinarySearchTree::begin() const {
+    Node* node = root;
+    while (node != nullptr && node->left != nullptr) {
+        node = node->left;
+    }
+    return iterator(node, this);
+}
+
+/**
+ * Iterator past the last course
+ */
+BinarySearchTree::iterator BinarySearchTree::end() const {
+    return iterator(nullptr, this);
+}
+
+/**
+ * Find the first node whose course ID is not less than (or greater than) an ID
+ *
+ * @param courseId Uppercase course ID to compare against
+ * @param inclusive true to include a node equal to the ID (lower bound), false to skip it (upper bound)
+ * @return the node, or nullptr when every course ID is smaller
+ */
+Node* BinarySearchTree::lowerBoundNode(const string& courseId, bool inclusive) {
+    CourseKey key(courseId);
+    Node* bound = nullptr;
+    Node* node = root;
+    while (node != nullptr) {
+        int result = compareCourseIds(node->key, node->course.courseId, key, courseId);
+
+        // the node qualifies, look for an earlier one on the left
+        if (result > 0 || (inclusive && result == 0)) {
+            bound = node;
+            node = node->left;
+        }
+        else {
+            node = node->right;
+        }
+    }
+    return bound;
+}
+
+/**
+ * Iterator to the first course whose ID is not less than an ID
+ *
+ * @param courseId Course ID to search for
+ */
+BinarySearchTree::iterator BinarySearchTree::lower_bound(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    return iterator(lowerBoundNode(courseId, true), this);
+}
+
+/**
+ * Iterator to the first course whose ID is greater than an ID
+ *
+ * @param courseId Course ID to search for
+ */
+BinarySearchTree::iterator BinarySearchTree::upper_bound(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    return iterator(lowerBoundNode(courseId, false), this);
+}
+
+/**
+ * Find a course by course ID
+ *
+ * @param courseId Course ID to find, in any case
+ * @return the course, or nullptr if it is not in the tree
+ */
+const Course* BinarySearchTree::Find(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    Node* node = findNode(courseId);
+    return (node != nullptr) ? &node->course : nullptr;
+}
+
+/**
+ * Approximate bytes held by the tree: node slabs, course strings and the
+ * frozen lookup index
+ */
+size_t BinarySearchTree::MemoryUsage() const {
+    size_t bytes = pool.Capacity() * sizeof(Node);
+    for (iterator it = begin(); it != end(); ++it) {
+        bytes += heapBytes(*it);
+    }
+    bytes += frozenKeys.capacity() * sizeof(CourseKey) + frozenNodes.capacity() * sizeof(Node*);
+    return bytes;
+}
+
+/**
+ * Height of the tree (0 for an empty tree)
+ */
+int BinarySearchTree::Height() {
+    return nodeHeight(root);
+}
+
+/**
+ * Height of a subtree, treating nullptr as an empty subtree
+ *
+ * @param node Root of the subtree
+ */
+int BinarySearchTree::nodeHeight(Node* node) {
+    // an empty subtree has a height of zero
+    if (node == nullptr) {
+        return 0;
+    }
+    return node->height;
+}
+
+/**
+ * Recompute the height of a node from its children
+ *
+ * @param node Node to update
+ */
+void BinarySearchTree::updateHeight(Node* node) {
+    node->height = 1 + max(nodeHeight(node->left), nodeHeight(node->right));
+}
+
+/**
+ * Rotate a subtree to the left, the right child becomes the new subtree root
+ *
+ * @param node Root of the subtree to rotate
+ * @return the new root of the subtree
+ */
+Node* BinarySearchTree::rotateLeft(Node* node) {
+    Node* pivot = node->right;
+
+    // the left subtree of the pivot moves under the old root
+    node->right = pivot->left;
+    if (node->right != nullptr) {
+        node->right->parent = node;
+    }
+    pivot->left = node;
+
+    // the pivot takes the place of the old root
+    pivot->parent = node->parent;
+    node->parent = pivot;
+
+    // heights must be updated bottom up
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+/**
+ * Rotate a subtree to the right, the left child becomes the new subtree root
+ *
+ * @param node Root of the subtree to rotate
+ * @return the new root of the subtree
+ */
+Node* BinarySearchTree::rotateRight(Node* node) {
+    Node* pivot = node->left;
+
+    // the right subtree of the pivot moves under the old root
+    node->left = pivot->right;
+    if (node->left != nullptr) {
+        node->left->parent = node;
+    }
+    pivot->right = node;
+
+    // the pivot takes the place of the old root
+    pivot->parent = node->parent;
+    node->parent = pivot;
+
+    // heights must be updated bottom up
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+/**
+ * Restore the AVL property at a node whose children differ in height by two
+ *
+ * @param node Root of the subtree to rebalance
+ * @return the new root of the subtree
+ */
+Node* BinarySearchTree::rebalance(Node* node) {
+    updateHeight(node);
+
+    int balance = nodeHeight(node->left) - nodeHeight(node->right);
+
+    // left heavy: single right rotation, or left-right if the left child leans right
+    if (balance > 1) {
+        if (nodeHeight(node->left->left) < nodeHeight(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+
+    // right heavy: single left rotation, or right-left if the right child leans left
+    if (balance < -1) {
+        if (nodeHeight(node->right->right) < nodeHeight(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+
+    return node;
+}
+
+/**
+ * Add a node below some node (recursive)
+ * In balanced mode the recursion depth is bounded by the AVL height, O(log n)
+ * Only the node pointer travels down, the course is never copied
+ *
+ * @param node Current node in tree
+ * @param newNode Node holding the course to be added
+ * @param added Set to false if a course with the same ID is found, the tree is then unchanged
+ * @return the root of the subtree after the course was added
+ */
+Node* BinarySearchTree::addNode(Node* node, Node* newNode, bool& added) {
+    // reached the bottom of the tree, this is where the course goes
+    if (node == nullptr) {
+        return newNode;
+    }
+
+    // the course ID is already in the tree, keep the first course
+    int order = compareCourseIds(node->key, node->course.courseId, newNode->key, newNode->course.courseId);
+    if (order == 0) {
+        added = false;
+        return node;
+    }
+
+    // if node is larger then add to left
+    if (order > 0) {
+        node->left = addNode(node->left, newNode, added);
+        node->left->parent = node;
+    }
+    // else add to right
+    else {
+        node->right = addNode(node->right, newNode, added);
+        node->right->parent = node;
+    }
+
+    // unbalanced mode only keeps the height current
+    if (!balanced) {
+        updateHeight(node);
+        return node;
+    }
+
+    // rebalance on the way back up
+    return rebalance(node);
+}
+//============================================================================
+// Flat hash storage class definition
+//============================================================================
+
+/**
+ * Define a catalog storage that keeps the courses in one flat vector and
+ * finds them through an open addressing table of positions, with linear
+ * probing over a power of two table kept at most half full
+ * Lookups are O(1) on average. Listing in course ID order sorts the
+ * positions the first time it is needed after a change (Freeze sorts them
+ * up front). Holds one course per ID, inserting an ID that is already stored is refused
+ */
+class FlatHashStorage {
+
+private:
+    // the courses in insertion order, with the hash of each course ID
+    vector<Course> courses;
+    vector<uint64_t> hashes;
+
+    // position in courses for each slot, -1 for an empty slot
+    vector<int> slots;
+
+    // positions of the courses in course ID order, valid while ordered is true
+    bool ordered;
+    vector<int> order;
+
+    size_t findSlot(string_view courseId, uint64_t hash) const;
+    void grow();
+    void sortOrder();
+
+public:
+    /**
+     * Forward iterator over the courses in course ID order
+     */
+    class iterator {
+
+    private:
+        const Course* courses;
+        const int* position;
+
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef Course value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const Course* pointer;
+        typedef const Course& reference;
+
+        iterator(const Course* aCourses = nullptr, const int* aPosition = nullptr) : courses(aCourses), position(aPosition) {}
+        reference operator*() const { return courses[*position]; }
+        pointer operator->() const { return &courses[*position]; }
+        iterator& operator++() { ++position; return *this; }
+        iterator operator++(int) { iterator old = *this; ++position; return old; }
+        bool operator==(const iterator& other) const { return position == other.position; }
+        bool operator!=(const iterator& other) const { return position != other.position; }
+    };
+
+    FlatHashStorage();
+    void Clear();
+    bool Insert(Course course);
+    template<typename... Args>
+    bool Emplace(Args&&... args);
+    bool Remove(string courseId);
+    bool Upsert(Course course);
+    void BuildFromSorted(vector<Course>& courseList);
+    void Freeze();
+    const Course* Find(string courseId);
+    int Size() const;
+    iterator begin();
+    iterator end();
+    iterator lower_bound(string courseId);
+    size_t MemoryUsage() const;
+    void printStats(ostream& out = cout);
+};
+
+/**
+ * Default constructor
+ */
+FlatHashStorage::FlatHashStorage() {
+    Clear();
+}
+
+/**
+ * Remove every course
+ */
+void FlatHashStorage::Clear() {
+    courses.clear();
+    hashes.clear();
+    slots.assign(16, -1);
+    order.clear();
+    ordered = true;
+}
+
+/**
+ * Slot holding a course ID, or the empty slot that ends its probe sequence
+ *
+ * @param courseId Uppercase course ID
+ * @param hash Hash of the course ID
+ */
+size_t FlatHashStorage::findSlot(string_view courseId, uint64_t hash) const {
+    size_t mask = slots.size() - 1;
+    size_t slot = hash & mask;
+    while (slots[slot] != -1 && !(hashes[slots[slot]] == hash && courses[slots[slot]].courseId == courseId)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * Double the table and put every course back in it
+ */
+void FlatHashStorage::grow() {
+    slots.assign(slots.size() * 2, -1);
+    size_t mask = slots.size() - 1;
+    for (int i = 0; i < (int)courses.size(); i++) {
+        size_t slot = hashes[i] & mask;
+        while (slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = i;
+    }
+}
+
+/**
+ * Insert a course, unless a course with the same ID is already stored
+ *
+ * @return false if the ID is already stored
+ */
+bool FlatHashStorage::Insert(Course course) {
+    uint64_t hash = CourseIdIndex::hashId(course.courseId);
+    size_t slot = findSlot(course.courseId, hash);
+    if (slots[slot] != -1) {
+        return false;
+    }
+
+    // append the course and keep the table at most half full
+    ordered = false;
+    slots[slot] = (int)courses.size();
+    courses.push_back(std::move(course));
+    hashes.push_back(hash);
+    if (courses.size() * 2 > slots.size()) {
+        grow();
+    }
+    return true;
+}
+
+/**
+ * Insert a course built from the arguments of a Course constructor
+ *
+ * @return false if the ID is already stored
+ */
+template<typename... Args>
+bool FlatHashStorage::Emplace(Args&&... args) {
+    return Insert(Course(std::forward<Args>(args)...));
+}
+
+/**
+ * Remove a course
+ * The slot is emptied by shifting the rest of its probe run back, so no
+ * markers for deleted slots are needed, and the last course moves into the
+ * freed position so the vector stays dense
+ *
+ * @param courseId ID of the course to remove
+ * @return true if a course was removed
+ */
+bool FlatHashStorage::Remove(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    size_t hole = findSlot(courseId, CourseIdIndex::hashId(courseId));
+    int position = slots[hole];
+    if (position == -1) {
+        return false;
+    }
+
+    // move later entries of the run into the hole when their home slot allows it
+    size_t mask = slots.size() - 1;
+    slots[hole] = -1;
+    for (size_t next = (hole + 1) & mask; slots[next] != -1; next = (next + 1) & mask) {
+        size_t home = hashes[slots[next]] & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            slots[next] = -1;
+            hole = next;
+        }
+    }
+
+    // fill the freed position with the last course
+    int last = (int)courses.size() - 1;
+    if (position != last) {
+        slots[findSlot(courses[last].courseId, hashes[last])] = position;
+        courses[position] = std::move(courses[last]);
+        hashes[position] = hashes[last];
+    }
+    courses.pop_back();
+    hashes.pop_back();
+    ordered = false;
+    return true;
+}
+
+/**
+ * Update a course in place, or insert it if its ID is not stored
+ *
+ * @param course Course to store
+ * @return true if the course was inserted, false if an existing course was updated
+ */
+bool FlatHashStorage::Upsert(Course course) {
+    transform(course.courseId.begin(), course.courseId.end(), course.courseId.begin(), ::toupper);
+    size_t slot = findSlot(course.courseId, CourseIdIndex::hashId(course.courseId));
+    if (slots[slot] != -1) {
+        // the ID is unchanged, so the order still holds
+        courses[slots[slot]].name = std::move(course.name);
+        courses[slots[slot]].prereq = std::move(course.prereq);
+        return false;
+    }
+    Insert(std::move(course));
+    return true;
+}
+
+/**
+ * Insert courses that are already sorted by course ID, keeping the first course of each ID
+ * Into an empty storage with no repeated IDs, the sorted order comes for free
+ *
+ * @param courseList Courses sorted by course ID (left empty afterwards)
+ */
+void FlatHashStorage::BuildFromSorted(vector<Course>& courseList) {
+    bool wasEmpty = courses.empty();
+    courses.reserve(courses.size() + courseList.size());
+    hashes.reserve(courses.capacity());
+    for (int i = 0; i < (int)courseList.size(); i++) {
+        Insert(std::move(courseList[i]));
+    }
+    if (wasEmpty && courses.size() == courseList.size()) {
+        order.resize(courses.size());
+        for (int i = 0; i < (int)order.size(); i++) {
+            order[i] = i;
+        }
+        ordered = true;
+    }
+    courseList.clear();
+}
+
+/**
+ * Sort the course order now, so listing the courses only reads
+ */
+void FlatHashStorage::Freeze() {
+    sortOrder();
+}
+
+/**
+ * Sort the positions of the courses by course ID, if a change unsorted them
+ */
+void FlatHashStorage::sortOrder() {
+    if (ordered) {
+        return;
+    }
+    order.resize(courses.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [this](int a, int b) {
+        return courses[a].courseId < courses[b].courseId;
+    });
+    ordered = true;
+}
+
+/**
+ * Find a course by course ID
+ *
+ * @param courseId Course ID to find, in any case
+ * @return the course, or nullptr if it is not stored
+ */
+const Course* FlatHashStorage::Find(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    int position = slots[findSlot(courseId, CourseIdIndex::hashId(courseId))];
+    return (position != -1) ? &courses[position] : nullptr;
+}
+
+/**
+ * Number of courses stored
+ */
+int FlatHashStorage::Size() const {
+    return (int)courses.size();
+}
+
+/**
+ * Iterator to the first course in order
+ */
+FlatHashStorage::iterator FlatHashStorage::begin() {
+    sortOrder();
+    return iterator(courses.data(), order.data());
+}
+
+/**
+ * Iterator past the last course
+ */
+FlatHashStorage::iterator FlatHashStorage::end() {
+    sortOrder();
+    return iterator(courses.data(), order.data() + order.size());
+}
+
+/**
+ * Iterator to the first course whose ID is not less than an ID
+ *
+ * @param courseId Course ID to search for
+ */
+FlatHashStorage::iterator FlatHashStorage::lower_bound(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    sortOrder();
+    const int* position = std::lower_bound(order.data(), order.data() + order.size(), courseId, [this](int at, const string& id) {
+        return courses[at].courseId < id;
+    });
+    return iterator(courses.data(), position);
+}
+
+/**
+ * Approximate bytes held: the courses and their strings, the hashes, the table and the order
+ */
+size_t FlatHashStorage::MemoryUsage() const {
+    size_t bytes = courses.capacity() * sizeof(Course) + hashes.capacity() * sizeof(uint64_t)
+        + slots.capacity() * sizeof(int) + order.capacity() * sizeof(int);
+    for (int i = 0; i < (int)courses.size(); i++) {
+        bytes += heapBytes(courses[i]);
+    }
+    return bytes;
+}
+
+/*
+Function for printing how full the table is and how long its probe runs are
+@param: stream to print to
+*/
+void FlatHashStorage::printStats(ostream& out) {
+    size_t mask = slots.size() - 1;
+    size_t longest = 0;
+    size_t total = 0;
+    for (size_t slot = 0; slot < slots.size(); slot++) {
+        if (slots[slot] != -1) {
+            size_t distance = (slot - (hashes[slots[slot]] & mask)) & mask;
+            longest = max(longest, distance);
+            total += distance;
+        }
+    }
+    out << "Flat hash: " << courses.size() << " courses, " << slots.size() << " slots, load factor "
+        << fixed << setprecision(2) << (double)courses.size() / slots.size() << '\n';
+    out << "Average probe distance: " << ((courses.empty()) ? 0.0 : (double)total / courses.size()) << ", longest: " << longest << '\n';
+}
+
+//============================================================================
+// Sorted vector storage class definition
+//============================================================================
+
+/**
+ * Define a catalog storage that keeps the courses in one vector sorted by
+ * course ID, with the packed key of each course in a second vector
+ * Lookups binary search the keys, listing reads the vector front to back.
+ * A single insert or remove shifts the courses after it, O(n), so the
+ * catalog is best loaded with BuildFromSorted
+ */
+class SortedVectorStorage {
+
+private:
+    vector<Course> courses;
+    vector<CourseKey> keys;
+
+    int lowerBound(const string& courseId, bool inclusive) const;
+
+public:
+    typedef vector<Course>::const_iterator iterator;
+
+    void Clear();
+    bool Insert(Course course);
+    template<typename... Args>
+    bool Emplace(Args&&... args);
+    bool Remove(string courseId);
+    bool Upsert(Course course);
+    void BuildFromSorted(vector<Course>& courseList);
+    void Freeze();
+    const Course* Find(string courseId);
+    int Size() const;
+    iterator begin() const;
+    iterator end() const;
+    iterator lower_bound(string courseId);
+    size_t MemoryUsage() const;
+    void printStats(ostream& out = cout);
+};
+
+/**
+ * Remove every course
+ */
+void SortedVectorStorage::Clear() {
+    courses.clear();
+    keys.clear();
+}
+
+/**
+ * Position of the first course whose ID is not less than (or greater than) an ID
+ *
+ * @param courseId Uppercase course ID to compare against
+ * @param inclusive true to include a course equal to the ID (lower bound), false to skip it (upper bound)
+ */
+int SortedVectorStorage::lowerBound(const string& courseId, bool inclusive) const {
+    CourseKey key(courseId);
+    int low = 0;
+    int high = (int)courses.size();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        int result = compareCourseIds(keys[mid], courses[mid].courseId, key, courseId);
+        if (result < 0 || (!inclusive && result == 0)) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Insert a course, unless a course with the same ID is already stored, O(n)
+ *
+ * @return false if the ID is already stored
+ */
+bool SortedVectorStorage::Insert(Course course) {
+    int position = lowerBound(course.courseId, true);
+    if (position < (int)courses.size() && courses[position].courseId == course.courseId) {
+        return false;
+    }
+    keys.insert(keys.begin() + position, CourseKey(course.courseId));
+    courses.insert(courses.begin() + position, std::move(course));
+    return true;
+}
+
+/**
+ * Insert a course built from the arguments of a Course constructor, O(n)
+ *
+ * @return false if the ID is already stored
+ */
+template<typename... Args>
+bool SortedVectorStorage::Emplace(Args&&... args) {
+    return Insert(Course(std::forward<Args>(args)...));
+}
+
+/**
+ * Remove a course, O(n)
+ *
+ * @param courseId ID of the course to remove
+ * @return true if a course was removed
+ */
+bool SortedVectorStorage::Remove(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    int position = lowerBound(courseId, true);
+    if (position == (int)courses.size() || courses[position].courseId != courseId) {
+        return false;
+    }
+    keys.erase(keys.begin() + position);
+    courses.erase(courses.begin() + position);
+    return true;
+}
+
+/**
+ * Update a course in place, or insert it if its ID is not stored
+ *
+ * @param course Course to store
+ * @return true if the course was inserted, false if an existing course was updated
+ */
+bool SortedVectorStorage::Upsert(Course course) {
+    transform(course.courseId.begin(), course.courseId.end(), course.courseId.begin(), ::toupper);
+    int position = lowerBound(course.courseId, true);
+    if (position < (int)courses.size() && courses[position].courseId == course.courseId) {
+        courses[position].name = std::move(course.name);
+        courses[position].prereq = std::move(course.prereq);
+        return false;
+    }
+    keys.insert(keys.begin() + position, CourseKey(course.courseId));
+    courses.insert(courses.begin() + position, std::move(course));
+    return true;
+}
+
+/**
+ * Load courses that are already sorted by course ID, keeping the first course of each ID
+ * An empty storage takes the whole vector, otherwise each course is inserted
+ *
+ * @param courseList Courses sorted by course ID (left empty afterwards)
+ */
+void SortedVectorStorage::BuildFromSorted(vector<Course>& courseList) {
+    if (courses.empty()) {
+        courses.swap(courseList);
+        courses.erase(unique(courses.begin(), courses.end(), [](const Course& a, const Course& b) {
+            return a.courseId == b.courseId;
+        }), courses.end());
+        keys.resize(courses.size());
+        for (int i = 0; i < (int)courses.size(); i++) {
+            keys[i] = CourseKey(courses[i].courseId);
+        }
+    }
+    else {
+        for (int i = 0; i < (int)courseList.size(); i++) {
+            Insert(std::move(courseList[i]));
+        }
+    }
+    courseList.clear();
+}
+
+/**
+ * Nothing to prepare, the vector is always sorted
+ */
+void SortedVectorStorage::Freeze() {
+}
+
+/**
+ * Find a course by course ID
+ *
+ * @param courseId Course ID to find, in any case
+ * @return the course, or nullptr if it is not stored
+ */
+const Course* SortedVectorStorage::Find(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    int position = lowerBound(courseId, true);
+    if (position == (int)courses.size() || courses[position].courseId != courseId) {
+        return nullptr;
+    }
+    return &courses[position];
+}
+
+/**
+ * Number of courses stored
+ */
+int SortedVectorStorage::Size() const {
+    return (int)courses.size();
+}
+
+/**
+ * Iterator to the first course in order
+ */
+SortedVectorStorage::iterator SortedVectorStorage::begin() const {
+    return courses.begin();
+}
+
+/**
+ * Iterator past the last course
+ */
+SortedVectorStorage::iterator SortedVectorStorage::end() const {
+    return courses.end();
+}
+
+/**
+ * Iterator to the first course whose ID is not less than an ID
+ *
+ * @param courseId Course ID to search for
+ */
+SortedVectorStorage::iterator SortedVectorStorage::lower_bound(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    return courses.begin() + lowerBound(courseId, true);
+}
+
+/**
+ * Approximate bytes held: the courses and their strings and the keys
+ */
+size_t SortedVectorStorage::MemoryUsage() const {
+    size_t bytes = courses.capacity() * sizeof(Course) + keys.capacity() * sizeof(CourseKey);
+    for (int i = 0; i < (int)courses.size(); i++) {
+        bytes += heapBytes(courses[i]);
+    }
+    return bytes;
+}
+
+/*
+Function for printing the size of the vector
+@param: stream to print to
+*/
+void SortedVectorStorage::printStats(ostream& out) {
+    out << "Sorted vector: " << courses.size() << " courses, capacity " << courses.capacity() << '\n';
+}
+
+//============================================================================
+// Course catalog class definition
+//============================================================================
+
+/**
+ * Define a catalog of courses over a storage chosen at compile time
+ *
+ * The storage holds the courses and answers insert, find and ordered
+ * iteration. The catalog adds the prerequisite graph, the closure, the name
+ * index and every print function on top, so the loader, the menu and batch
+ * mode work the same with any storage. A storage provides:
+ *   void Clear()
+ *   bool Insert(Course course)          false if the ID is already stored, the first course is kept
+ *   bool Remove(string courseId)
+ *   bool Upsert(Course course)
+ *   void BuildFromSorted(vector<Course>& courses)
+ *   void Freeze()                      ready for lookups, iteration only reads
+ *   const Course* Find(string courseId)
+ *   int Size() const
+ *   iterator begin(), end(), lower_bound(string courseId), in course ID order
+ *   size_t MemoryUsage() const
+ *   void printStats(ostream& out)
+ * BinarySearchTree, FlatHashStorage and SortedVectorStorage are storages
+ */
+template<typename Storage>
+class CourseCatalog {
+
+private:
+    Storage storage;
+
+    // prerequisites resolved to course numbers, rebuilt after the catalog changes
+    bool graphBuilt;
+    CourseGraph graph;
+
+    // course of each course number of the graph
+    vector<const Course*> graphCourses;
+
+    // every course required before each course, rebuilt after the graph changes
+    bool closureBuilt;
+    PrerequisiteClosure closure;
+
+    // trigram index of the course names, rebuilt after the graph changes
+    bool nameIndexBuilt;
+    CourseNameIndex nameIndex;
+
+    // changes on every mutation, rendered output is reused while its version matches
+    uint64_t version;
+
+    // the full listing, and the detail block of every course number of the graph in one buffer
+    uint64_t listingVersion;
+    string listing;
+    uint64_t detailVersion;
+    string details;
+    vector<size_t> detailStart;
+
+    void invalidate();
+    static void renderCourse(const Course& course, string& text);
+    const string& renderedListing();
+    string_view renderedCourse(const Course* course);
+
+public:
+    typedef typename Storage::iterator iterator;
+
+    CourseCatalog();
+    CourseCatalog(const CourseCatalog&) = delete;
+    CourseCatalog& operator=(const CourseCatalog&) = delete;
+    Storage& Store();
+    void Clear();
+    bool Insert(Course course);
+    template<typename... Args>
+    bool Emplace(Args&&... args);
+    bool Remove(string courseId);
+    bool Upsert(Course course);
+    int Size() const;
+    const Course* Find(string courseId);
+    size_t MemoryUsage() const;
+    void BuildFromSorted(vector<Course>& courses);
+    void Freeze();
+    const CourseGraph& PrerequisiteGraph();
+    const PrerequisiteClosure& TransitivePrerequisites();
+    const CourseNameIndex& NameIndex();
+    vector<string> AllPrerequisites(string courseId);
+    bool IsPrerequisiteOf(string prereqId, string courseId);
+    vector<const Course*> SearchNames(string query);
+    uint64_t Version() const;
+    void Render();
+    iterator begin();
+    iterator end();
+    iterator lower_bound(string courseId);
+    vector<const Course*> RangeQuery(string lowId, string highId);
+    vector<const Course*> PrefixQuery(string prefix);
+    void printSampleSchedule(ostream& out = cout);
+    void printCoursesWithPrefix(string prefix, ostream& out = cout);
+    void printCoursesInRange(string lowId, string highId, ostream& out = cout);
+    void printNameSearch(string query, ostream& out = cout);
+    void printPrerequisiteSchedule(ostream& out = cout);
+    void printAllPrerequisites(string courseId, ostream& out = cout);
+    void printCourseInformation(string courseId, ostream& out = cout);
+    void printStats(ostream& out = cout);
+};
+
+/**
+ * Default constructor
+ */
+template<typename Storage>
+CourseCatalog<Storage>::CourseCatalog() {
+    // the prerequisite graph, its closure, the name index and rendered output are built on first use
+    graphBuilt = false;
+    closureBuilt = false;
+    nameIndexBuilt = false;
+    version = 1;
+    listingVersion = 0;
+    detailVersion = 0;
+}
+
+/**
+ * The storage holding the courses, for anything specific to it
+ * Changing the courses through it leaves the indexes stale
+ */
+template<typename Storage>
+Storage& CourseCatalog<Storage>::Store() {
+    return storage;
+}
+
+/**
+ * Drop every index and rendered output built from the courses
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::invalidate() {
+    graphBuilt = false;
+    graph = CourseGraph();
+    graphCourses.clear();
+
+    // the closure keeps its bitsets so unchanged components can be reused
+    closureBuilt = false;
+    nameIndexBuilt = false;
+
+    // rendered output of the earlier version is stale, its memory is kept for the next render
+    version += 1;
+}
+
+/**
+ * Remove every course
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::Clear() {
+    invalidate();
+    storage.Clear();
+}
+
+/**
+ * Insert a course
+ *
+ * @return false if a course with the same ID is already in the catalog
+ */
+template<typename Storage>
+bool CourseCatalog<Storage>::Insert(Course course) {
+    invalidate();
+    return storage.Insert(std::move(course));
+}
+
+/**
+ * Insert a course built from the arguments of a Course constructor,
+ * such as Emplace(courseId, name)
+ *
+ * @return false if a course with the same ID is already in the catalog
+ */
+template<typename Storage>
+template<typename... Args>
+bool CourseCatalog<Storage>::Emplace(Args&&... args) {
+    invalidate();
+    return storage.Emplace(std::forward<Args>(args)...);
+}
+
+/**
+ * Remove a course
+ *
+ * @param courseId ID of the course to remove
+ * @return true if a course was removed
+ */
+template<typename Storage>
+bool CourseCatalog<Storage>::Remove(string courseId) {
+    if (!storage.Remove(courseId)) {
+        return false;
+    }
+    invalidate();
+    return true;
+}
+
+/**
+ * Update a course in place, or insert it if its ID is not in the catalog
+ *
+ * @param course Course to store
+ * @return true if the course was inserted, false if an existing course was updated
+ */
+template<typename Storage>
+bool CourseCatalog<Storage>::Upsert(Course course) {
+    invalidate();
+    return storage.Upsert(std::move(course));
+}
+
+/**
+ * Number of courses in the catalog
+ */
+template<typename Storage>
+int CourseCatalog<Storage>::Size() const {
+    return storage.Size();
+}
+
+/**
+ * Find a course by course ID
+ *
+ * @param courseId Course ID to find, in any case
+ * @return the course, or nullptr if it is not in the catalog
+ */
+template<typename Storage>
+const Course* CourseCatalog<Storage>::Find(string courseId) {
+    return storage.Find(courseId);
+}
+
+/**
+ * Approximate bytes held by the storage (the indexes are not counted)
+ */
+template<typename Storage>
+size_t CourseCatalog<Storage>::MemoryUsage() const {
+    return storage.MemoryUsage();
+}
+
+/**
+ * Load courses that are already sorted by course ID
+ *
+ * @param courses Courses sorted by course ID (left empty afterwards)
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::BuildFromSorted(vector<Course>& courses) {
+    invalidate();
+    storage.BuildFromSorted(courses);
+}
+
+/**
+ * Prepare the storage for a lookup heavy workload, until the next change
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::Freeze() {
+    storage.Freeze();
+}
+
+/**
+ * Prerequisite graph of the courses in the catalog, built on first use
+ * after the catalog changes
+ */
+template<typename Storage>
+const CourseGraph& CourseCatalog<Storage>::PrerequisiteGraph() {
+    if (!graphBuilt) {
+        // the graph points into the courses held by the storage, in course ID order
+        graphCourses.clear();
+        graphCourses.reserve(storage.Size());
+        for (iterator it = storage.begin(); it != storage.end(); ++it) {
+            graphCourses.push_back(&*it);
+        }
+        graph.Build(graphCourses);
+        graphBuilt = true;
+    }
+    return graph;
+}
+
+/**
+ * Transitive prerequisites of the courses in the catalog, built on first use
+ * after the catalog changes
+ */
+template<typename Storage>
+const PrerequisiteClosure& CourseCatalog<Storage>::TransitivePrerequisites() {
+    if (!closureBuilt) {
+        closure.Build(PrerequisiteGraph());
+        closureBuilt = true;
+    }
+    return closure;
+}
+
+/**
+ * Trigram index of the course names, built on first use after the catalog changes
+ */
+template<typename Storage>
+const CourseNameIndex& CourseCatalog<Storage>::NameIndex() {
+    if (!nameIndexBuilt) {
+        nameIndex.Build(PrerequisiteGraph());
+        nameIndexBuilt = true;
+    }
+    return nameIndex;
+}
+
+/**
+ * Every course required before a course, directly or through other prerequisites
+ *
+ * @param courseId Course to list the prerequisites of
+ * @return the course IDs in order, empty if the course is not in the catalog
+ */
+template<typename Storage>
+vector<string> CourseCatalog<Storage>::AllPrerequisites(string courseId) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    vector<string> result;
+    const PrerequisiteClosure& prereqs = TransitivePrerequisites();
+    int course = graph.courseIndex.Find(courseId);
+    if (course != -1) {
+        vector<int> found = prereqs.AllPrerequisites(course);
+        for (int i = 0; i < (int)found.size(); i++) {
+            result.push_back(string(graph.courseIds[found[i]]));
+        }
+    }
+    return result;
+}
+
+/**
+ * Check if one course must be taken, directly or indirectly, before another
+ *
+ * @param prereqId Possible prerequisite
+ * @param courseId Later course
+ */
+template<typename Storage>
+bool CourseCatalog<Storage>::IsPrerequisiteOf(string prereqId, string courseId) {
+    transform(prereqId.begin(), prereqId.end(), prereqId.begin(), ::toupper);
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    const PrerequisiteClosure& prereqs = TransitivePrerequisites();
+    int prereq = graph.courseIndex.Find(prereqId);
+    int course = graph.courseIndex.Find(courseId);
+    return prereq != -1 && course != -1 && prereqs.IsPrerequisiteOf(prereq, course);
+}
+
+/**
+ * Every course whose name holds each word of a query, ignoring case
+ *
+ * @param query Words to find, such as "data structures"
+ * @return the courses in course ID order
+ */
+template<typename Storage>
+vector<const Course*> CourseCatalog<Storage>::SearchNames(string query) {
+    vector<int> found = NameIndex().Search(query);
+
+    // course numbers follow the course ID order of the storage
+    vector<const Course*> result(found.size());
+    for (int i = 0; i < (int)found.size(); i++) {
+        result[i] = graphCourses[found[i]];
+    }
+    return result;
+}
+
+/**
+ * Iterator to the first course in order
+ */
+template<typename Storage>
+typename CourseCatalog<Storage>::iterator CourseCatalog<Storage>::begin() {
+    return storage.begin();
+}
+
+/**
+ * Iterator past the last course
+ */
+template<typename Storage>
+typename CourseCatalog<Storage>::iterator CourseCatalog<Storage>::end() {
+    return storage.end();
+}
+
+/**
+ * Iterator to the first course whose ID is not less than an ID
+ *
+ * @param courseId Course ID to search for
+ */
+template<typename Storage>
+typename CourseCatalog<Storage>::iterator CourseCatalog<Storage>::lower_bound(string courseId) {
+    return storage.lower_bound(courseId);
+}
+
+/**
+ * Every course with an ID from lowId to highId, both included, in O(log n + k)
+ * for the ordered storages
+ *
+ * @param lowId First course ID of the range
+ * @param highId Last course ID of the range
+ */
+template<typename Storage>
+vector<const Course*> CourseCatalog<Storage>::RangeQuery(string lowId, string highId) {
+    transform(lowId.begin(), lowId.end(), lowId.begin(), ::toupper);
+    transform(highId.begin(), highId.end(), highId.begin(), ::toupper);
+
+    // walk from the first course in the range until a course is past its end
+    vector<const Course*> result;
+    CourseKey highKey(highId);
+    for (iterator it = storage.lower_bound(lowId); it != storage.end(); ++it) {
+        if (compareCourseIds(CourseKey(it->courseId), it->courseId, highKey, highId) > 0) {
+            break;
+        }
+        result.push_back(&*it);
+    }
+    return result;
+}
+
+/**
+ * Every course whose ID starts with a prefix, such as CSCI3 for all
+ * CSCI3xx courses, in O(log n + k) for the ordered storages
+ *
+ * @param prefix Start of the course IDs to list
+ */
+template<typename Storage>
+vector<const Course*> CourseCatalog<Storage>::PrefixQuery(string prefix) {
+    transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+
+    // the matching IDs are contiguous, starting at the prefix itself
+    vector<const Course*> result;
+    for (iterator it = storage.lower_bound(prefix); it != storage.end(); ++it) {
+        if (it->courseId.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        result.push_back(&*it);
+    }
+    return result;
+}
+
+/*
+Function for printing the shape of the storage behind the catalog
+@param: stream to print to
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printStats(ostream& out) {
+    storage.printStats(out);
+    out << "Render cache: " << ((listingVersion == version) ? listing.size() : 0) << " listing bytes, "
+        << ((detailVersion == version) ? details.size() : 0) << " course detail bytes" << '\n';
+}
+
+/**
+ * Version of the catalog, it changes whenever a course is added, changed or removed
+ */
+template<typename Storage>
+uint64_t CourseCatalog<Storage>::Version() const {
+    return version;
+}
+
+/**
+ * Append the detail block of a course as printCourseInformation prints it
+ *
+ * @param course Course to render
+ * @param text String the block is appended to
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::renderCourse(const Course& course, string& text) {
+    text += course.courseId;
+    text += ", ";
+    text += course.name;
+    text += '\n';
+    for (int i = 0; i < (int)course.prereq.size(); i++) {
+        text += (i == 0) ? "Prerequisites: " : ", ";
+        text += course.prereq[i];
+    }
+    text += '\n';
+}
+
+/**
+ * Every course in order as printSampleSchedule prints it, rendered once per version
+ */
+template<typename Storage>
+const string& CourseCatalog<Storage>::renderedListing() {
+    if (listingVersion != version) {
+        listing.clear();
+        for (iterator it = begin(); it != end(); ++it) {
+            listing += it->courseId;
+            listing += ", ";
+            listing += it->name;
+            listing += '\n';
+        }
+        listingVersion = version;
+    }
+    return listing;
+}
+
+/**
+ * Detail block of a course, every block is rendered into one buffer once per version
+ *
+ * @param course Course found in the storage
+ * @return the block, pointing into the buffer
+ */
+template<typename Storage>
+string_view CourseCatalog<Storage>::renderedCourse(const Course* course) {
+    const CourseGraph& courseGraph = PrerequisiteGraph();
+    if (detailVersion != version) {
+        details.clear();
+        detailStart.assign(graphCourses.size() + 1, 0);
+        for (int i = 0; i < (int)graphCourses.size(); i++) {
+            detailStart[i] = details.size();
+            renderCourse(*graphCourses[i], details);
+        }
+        detailStart[graphCourses.size()] = details.size();
+        detailVersion = version;
+    }
+
+    int number = courseGraph.courseIndex.Find(course->courseId);
+    return string_view(details.data() + detailStart[number], detailStart[number + 1] - detailStart[number]);
+}
+
+/**
+ * Render the listing and every detail block now, so printing only reads them
+ * A catalog shared between threads must be rendered before it is shared
+ */
+template<typename Storage>
+void CourseCatalog<Storage>::Render() {
+    renderedListing();
+    if (storage.Size() > 0) {
+        renderedCourse(&*begin());
+    }
+}
+
+// storage of the catalog, picked at compile time with -DCOURSE_STORAGE_HASH or
+// -DCOURSE_STORAGE_VECTOR, the binary search tree otherwise
+#if defined(COURSE_STORAGE_HASH)
+typedef CourseCatalog<FlatHashStorage> Catalog;
+#elif defined(COURSE_STORAGE_VECTOR)
+typedef CourseCatalog<SortedVectorStorage> Catalog;
+#else
+typedef CourseCatalog<BinarySearchTree> Catalog;
+#endif
+
+/*
+Functions giving the course ID to sort by, so the sorts below take either
+course IDs or whole courses
+@param: course ID or course
+*/
+inline const string& courseIdOf(const string& courseId) {
+    return courseId;
+}
+
+inline const string& courseIdOf(const Course& course) {
+    return course.courseId;
+}
+
+/**
+ * Partition course IDs or courses into two parts, low and high
+ *
+ * @param items Address of the vector of course IDs or courses to partition
+ * @param begin Beginning index to partition
+ * @param end Ending index to partition
+ * @return the last index of the low part
+ */
+template<typename Item>
+int partition(vector<Item>& items, int begin, int end) {
+    //set low and high equal to begin and end
+    int low = begin;
+    int high = end;
+
+    // pick the middle element as pivot point
+    int midpoint = low + (high - low) / 2;
+    string pivot = courseIdOf(items[midpoint]);
+
+    // initialize loop exit condition
+    bool done = false;
+
+    // while not done 
+    while (!done) {
+
+        // keep incrementing low index while the ID at low is below the pivot
+        while (courseIdOf(items[low]) < pivot) {
+            low += 1;
+        }
+
+        // keep decrementing high index while the pivot is below the ID at high
+        while (pivot < courseIdOf(items[high])) {
+            high -= 1;
+        }
+
+        /* If there are zero or one elements remaining,
+            all items are partitioned. Return high */
+        if (low >= high) {
+            done = true;
+            return high;
+        }
+        else {
+            // else swap the low and high items
+            std::swap(items[low], items[high]);
+
+            // move low and high closer ++low, --high
+            low += 1;
+            high -= 1;
+        }
+
+    }
+    return high;
+}
+
+/**
+ * Insertion sort for small ranges of course IDs or courses, stable
+ * Characters before depth are known to be equal and are skipped
+ *
+ * @param items Address of the vector of course IDs or courses to sort
+ * @param begin First index to sort
+ * @param end One past the last index to sort
+ * @param depth Number of leading characters shared by the whole range
+ */
+template<typename Item>
+void insertionSort(vector<Item>& items, int begin, int end, size_t depth) {
+    for (int i = begin + 1; i < end; i++) {
+        Item key = std::move(items[i]);
+
+        // shift larger IDs one slot to the right
+        int j = i - 1;
+        while (j >= begin && courseIdOf(items[j]).compare(depth, string::npos, courseIdOf(key), depth, string::npos) > 0) {
+            items[j + 1] = std::move(items[j]);
+            j -= 1;
+        }
+        items[j + 1] = std::move(key);
+    }
+}
+
+/**
+ * Perform an MSD radix sort on course IDs or courses
+ * Every pass distributes the range by the character at depth, then each
+ * bucket is sorted on the next character. Cost is O(n * key length).
+ * Equal IDs keep their order, the distribution and insertion sort are stable
+ *
+ * @param items Address of the vector of course IDs or courses to sort
+ * @param buffer Scratch vector at least as large as items
+ * @param begin First index to sort
+ * @param end One past the last index to sort
+ * @param depth Number of leading characters shared by the whole range
+ */
+template<typename Item>
+void radixSort(vector<Item>& items, vector<Item>& buffer, int begin, int end, size_t depth) {
+    // small buckets are cheaper to finish with insertion sort
+    const int INSERTION_SORT_SIZE = 32;
+    if (end - begin <= INSERTION_SORT_SIZE) {
+        insertionSort(items, begin, end, depth);
+        return;
+    }
+
+    // bucket 0 holds IDs that end before depth, bucket c + 1 holds character c
+    const int BUCKETS = 257;
+    vector<int> bucketStart(BUCKETS + 1, 0);
+    for (int i = begin; i < end; i++) {
+        const string& id = courseIdOf(items[i]);
+        int bucket = (id.size() > depth) ? (unsigned char)id[depth] + 1 : 0;
+        bucketStart[bucket + 1] += 1;
+    }
+
+    // turn the counts into starting offsets
+    for (int b = 0; b < BUCKETS; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // distribute into the buffer, then move back in bucket order
+    vector<int> next(bucketStart.begin(), bucketStart.end() - 1);
+    for (int i = begin; i < end; i++) {
+        const string& id = courseIdOf(items[i]);
+        int bucket = (id.size() > depth) ? (unsigned char)id[depth] + 1 : 0;
+        buffer[begin + next[bucket]] = std::move(items[i]);
+        next[bucket] += 1;
+    }
+    for (int i = begin; i < end; i++) {
+        items[i] = std::move(buffer[i]);
+    }
+
+    // IDs in bucket 0 are all equal, sort every other bucket on the next character
+    for (int b = 1; b < BUCKETS; b++) {
+        if (bucketStart[b + 1] - bucketStart[b] > 1) {
+            radixSort(items, buffer, begin + bucketStart[b], begin + bucketStart[b + 1], depth + 1);
+        }
+    }
+}
+
+/**
+ * Perform an introsort on course IDs or courses
+ * Quick sort with a median of three pivot, switching to heap sort once the
+ * recursion gets too deep, so the worst case is O(n log(n)). Only the smaller
+ * partition is recursed into, which bounds the stack depth to O(log(n)).
+ * Not stable, equal IDs may change order
+ *
+ * @param items Address of the vector of course IDs or courses to sort
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ * @param depthLimit partitions left before switching to heap sort
+ */
+template<typename Item>
+void introSort(vector<Item>& items, int begin, int end, int depthLimit) {
+    const int INSERTION_SORT_SIZE = 16;
+    auto idLess = [](const Item& a, const Item& b) {
+        return courseIdOf(a) < courseIdOf(b);
+    };
+
+    while (end - begin >= INSERTION_SORT_SIZE) {
+
+        // too many bad pivots, heap sort the rest of the range
+        if (depthLimit == 0) {
+            make_heap(items.begin() + begin, items.begin() + end + 1, idLess);
+            sort_heap(items.begin() + begin, items.begin() + end + 1, idLess);
+            return;
+        }
+        depthLimit -= 1;
+
+        // order the first, middle and last IDs so the middle one is their median
+        int midpoint = begin + (end - begin) / 2;
+        if (idLess(items[midpoint], items[begin])) {
+            std::swap(items[midpoint], items[begin]);
+        }
+        if (idLess(items[end], items[begin])) {
+            std::swap(items[end], items[begin]);
+        }
+        if (idLess(items[end], items[midpoint])) {
+            std::swap(items[end], items[midpoint]);
+        }
+
+        // partition around the middle element
+        int mid = partition(items, begin, end);
+
+        // recurse into the smaller partition and loop on the larger one
+        if (mid - begin < end - mid) {
+            introSort(items, begin, mid, depthLimit);
+            begin = mid + 1;
+        }
+        else {
+            introSort(items, mid + 1, end, depthLimit);
+            end = mid;
+        }
+    }
+
+    // finish the small range with insertion sort
+    insertionSort(items, begin, end + 1, 0);
+}
+
+/**
+ * Partitions introsort allows before switching to heap sort, 2 * log2(n)
+ *
+ * @param count Number of course IDs to sort
+ */
+int introSortDepthLimit(int count) {
+    int depthLimit = 0;
+    for (int n = count; n > 1; n >>= 1) {
+        depthLimit += 2;
+    }
+    return depthLimit;
+}
+
+/**
+ * Sort courses by course ID
+ * Course IDs are short, so they are radix sorted. Any longer ID falls back
+ * to introsort, so arbitrary input is still O(n log(n)). Introsort is not
+ * stable, which the loader does not need since it drops repeated IDs first.
+ * With several threads each thread sorts one slice, then the slices are cut
+ * at splitter IDs sampled from all of them and each thread merges one part
+ * of every slice straight into its place in the result
+ *
+ * @param courses address of the vector of courses to be sorted
+ * @param threadCount Number of threads to sort with
+ */
+void sortCoursesById(vector<Course>& courses, int threadCount) {
+    // longest ID the radix sort is used for
+    const size_t MAX_RADIX_KEY = 16;
+
+    // small lists are not worth splitting
+    const int MIN_SLICE_SIZE = 1 << 16;
+
+    int count = (int)courses.size();
+    if (count <= 1) {
+        return;
+    }
+    threadCount = max(1, min(threadCount, count / MIN_SLICE_SIZE));
+
+    // radix sort only when every ID is a short key
+    bool shortKeys = true;
+    for (int i = 0; i < count && shortKeys; i++) {
+        shortKeys = courses[i].courseId.size() <= MAX_RADIX_KEY;
+    }
+
+    // one thread sorts the courses in place
+    if (threadCount == 1) {
+        if (shortKeys) {
+            vector<Course> buffer(count);
+            radixSort(courses, buffer, 0, count, 0);
+        }
+        else {
+            introSort(courses, 0, count - 1, introSortDepthLimit(count));
+        }
+        return;
+    }
+
+    // otherwise each thread moves a slice out and sorts it, with any buffer allocated by that thread
+    vector<vector<Course>> slices(threadCount);
+    runParallel(threadCount, [&](int slice) {
+        int begin = (int)((long long)count * slice / threadCount);
+        int end = (int)((long long)count * (slice + 1) / threadCount);
+        vector<Course>& sorted = slices[slice];
+        sorted.assign(make_move_iterator(courses.begin() + begin), make_move_iterator(courses.begin() + end));
+        if (shortKeys) {
+            vector<Course> buffer(sorted.size());
+            radixSort(sorted, buffer, 0, (int)sorted.size(), 0);
+        }
+        else {
+            introSort(sorted, 0, (int)sorted.size() - 1, introSortDepthLimit((int)sorted.size()));
+        }
+    });
+
+    // splitter IDs evenly spaced through samples taken evenly from every slice
+    vector<string> samples;
+    for (int slice = 0; slice < threadCount; slice++) {
+        for (int k = 1; k < threadCount; k++) {
+            samples.push_back(slices[slice][slices[slice].size() * k / threadCount].courseId);
+        }
+    }
+    sort(samples.begin(), samples.end());
+    vector<string> splitters;
+    for (int part = 1; part < threadCount; part++) {
+        splitters.push_back(samples[samples.size() * part / threadCount]);
+    }
+
+    // part p of each slice holds its IDs from splitter p - 1 up to splitter p
+    vector<vector<int>> cut(threadCount, vector<int>(threadCount + 1));
+    for (int slice = 0; slice < threadCount; slice++) {
+        cut[slice][0] = 0;
+        cut[slice][threadCount] = (int)slices[slice].size();
+        for (int part = 1; part < threadCount; part++) {
+            cut[slice][part] = (int)(lower_bound(slices[slice].begin() + cut[slice][part - 1], slices[slice].end(), splitters[part - 1],
+                [](const Course& course, const string& courseId) {
+                    return course.courseId < courseId;
+                }) - slices[slice].begin());
+        }
+    }
+
+    // each thread merges part p of every slice back into place, after the courses of the parts before it
+    runParallel(threadCount, [&](int part) {
+        int out = 0;
+        vector<int> next(threadCount);
+        for (int slice = 0; slice < threadCount; slice++) {
+            out += cut[slice][part];
+            next[slice] = cut[slice][part];
+        }
+
+        // a heap of the slices by the ID at the front of their part, the earlier slice first on a tie
+        auto later = [&](int a, int b) {
+            int order = slices[a][next[a]].courseId.compare(slices[b][next[b]].courseId);
+            return order > 0 || (order == 0 && a > b);
+        };
+        priority_queue<int, vector<int>, decltype(later)> fronts(later);
+        for (int slice = 0; slice < threadCount; slice++) {
+            if (next[slice] < cut[slice][part + 1]) {
+                fronts.push(slice);
+            }
+        }
+        while (!fronts.empty()) {
+            int slice = fronts.top();
+            fronts.pop();
+            courses[out] = std::move(slices[slice][next[slice]]);
+            out += 1;
+            next[slice] += 1;
+            if (next[slice] < cut[slice][part + 1]) {
+                fronts.push(slice);
+            }
+        }
+    });
+
+    // free the emptied slices on their threads too
+    runParallel(threadCount, [&](int slice) {
+        vector<Course>().swap(slices[slice]);
+    });
+}
+
+//============================================================================
+// Memory mapped file class definition
+//============================================================================
+
+/**
+ * Define a class that maps a whole file into memory for reading
+ * Falls back to reading the file into a buffer where mmap is not available
+ */
+class MappedFile {
+
+private:
+    const char* data;
+    size_t size;
+
+#ifdef _WIN32
+    // contents of the file when it cannot be mapped
+    string buffer;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    bool Open(const string& path);
+    void Close();
+    const char* Data();
+    size_t Size();
+};
+
+/**
+ * Default constructor
+ */
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+}
+
+/**
+ * Destructor, unmaps the file
+ */
+MappedFile::~MappedFile() {
+    Close();
+}
+
+/**
+ * Map a file into memory
+ *
+ * @param path Path of the file to map
+ * @return true if the file could be opened
+ */
+bool MappedFile::Open(const string& path) {
+    Close();
+
+#ifdef _WIN32
+    // read the whole file with a single read
+    ifstream file(path, ios::binary);
+    if (!file.good()) {
+        return false;
+    }
+    buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // find the file size, an empty file needs no mapping
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    size = (size_t)info.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+
+    // map the file, the mapping stays valid after the descriptor is closed
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+
+    // the file is read front to back
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapping);
+    return true;
+#endif
+}
+
+/**
+ * Release the mapping
+ */
+void MappedFile::Close() {
+#ifdef _WIN32
+    buffer.clear();
+#else
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+/**
+ * First byte of the file
+ */
+const char* MappedFile::Data() {
+    return data;
+}
+
+/**
+ * Number of bytes in the file
+ */
+size_t MappedFile::Size() {
+    return size;
+}
+
+//============================================================================
+// CSV tokenizer definitions
+//============================================================================
+
+/*
+Fields are split on the characters that matter to CSV (RFC 4180): the comma
+between fields, the quote around a field that holds commas, quotes or
+newlines, and the newline between records. A mask function marks where they
+are in a block of 64 bytes, one bit per byte; the SSE2 and AVX2 versions
+compare 16 or 32 bytes at once. The tokenizer then steps from one set bit to
+the next instead of looking at every byte. The best mask function for the CPU
+is picked once at startup
+*/
+typedef uint64_t (*CsvMaskFunction)(const char* block);
+
+/*
+Function to mark the commas, quotes and newlines of a block, one byte at a time
+@param: 64 bytes of text
+@return: bit i set if byte i is one of them
+*/
+uint64_t csvSpecialMaskScalar(const char* block) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 64; i++) {
+        if (block[i] == ',' || block[i] == '"' || block[i] == '\n') {
+            bits |= 1ULL << i;
+        }
+    }
+    return bits;
+}
+
+#ifdef CSV_SIMD_X86
+/*
+Function to mark the commas, quotes and newlines of a block, 16 bytes at a time
+@param: 64 bytes of text
+@return: bit i set if byte i is one of them
+*/
+uint64_t csvSpecialMaskSse2(const char* block) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i newline = _mm_set1_epi8('\n');
+    uint64_t bits = 0;
+    for (int i = 0; i < 64; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, quote)), _mm_cmpeq_epi8(bytes, newline));
+        bits |= (uint64_t)(uint32_t)_mm_movemask_epi8(found) << i;
+    }
+    return bits;
+}
+
+/*
+Function to mark the commas, quotes and newlines of a block, 32 bytes at a time
+Only called when the CPU supports AVX2
+@param: 64 bytes of text
+@return: bit i set if byte i is one of them
+*/
+__attribute__((target("avx2")))
+uint64_t csvSpecialMaskAvx2(const char* block) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+    __m256i lowFound = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(low, comma), _mm256_cmpeq_epi8(low, quote)), _mm256_cmpeq_epi8(low, newline));
+    __m256i highFound = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(high, comma), _mm256_cmpeq_epi8(high, quote)), _mm256_cmpeq_epi8(high, newline));
+    return (uint64_t)(uint32_t)_mm256_movemask_epi8(lowFound) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(highFound) << 32);
+}
+#endif
+
+/*
+Function to list the mask functions this CPU can run, slowest first
+*/
+vector<pair<string, CsvMaskFunction>> availableCsvMasks() {
+    vector<pair<string, CsvMaskFunction>> masks;
+    masks.push_back(make_pair("scalar", csvSpecialMaskScalar));
+#ifdef CSV_SIMD_X86
+    masks.push_back(make_pair("sse2", csvSpecialMaskSse2));
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        masks.push_back(make_pair("avx2", csvSpecialMaskAvx2));
+    }
+#endif
+    return masks;
+}
+
+// the fastest mask function for this CPU, the benchmark swaps in the others
+CsvMaskFunction csvSpecialMask = availableCsvMasks().back().second;
+
+/*
+Function to mark the commas, quotes and newlines of up to 64 bytes
+@param: first byte, end of the text, nothing at or past it is read
+@return: bit i set if byte i is one of them
+*/
+inline uint64_t csvSpecialBits(const char* p, const char* end) {
+    if (end - p >= 64) {
+        return csvSpecialMask(p);
+    }
+
+    // a short tail is copied into a full block first
+    char block[64] = {};
+    memcpy(block, p, end - p);
+    return csvSpecialMask(block) & ((1ULL << (end - p)) - 1);
+}
+
+/*
+Function to find the first comma, quote or newline in a range
+@param: first character of the range, one past the last
+@return: the character found, or end
+*/
+const char* findCsvSpecial(const char* begin, const char* end) {
+    for (const char* p = begin; p < end; p += 64) {
+        uint64_t bits = csvSpecialBits(p, end);
+        if (bits != 0) {
+            return p + lowestSetBit(bits);
+        }
+    }
+    return end;
+}
+
+/**
+ * Define a field of a CSV record, pointing into the text
+ * A quoted field points inside its quotes, and escaped says it still holds
+ * doubled quotes that stand for one quote each
+ */
+struct CsvField {
+    string_view text;
+    bool escaped;
+};
+
+/*
+Function to copy the value of a field, turning doubled quotes back into quotes
+@param: field to copy
+*/
+string csvFieldString(const CsvField& field) {
+    if (!field.escaped) {
+        return string(field.text);
+    }
+    string value;
+    value.reserve(field.text.size());
+    for (size_t i = 0; i < field.text.size(); i++) {
+        value += field.text[i];
+        if (field.text[i] == '"' && i + 1 < field.text.size() && field.text[i + 1] == '"') {
+            i += 1;
+        }
+    }
+    return value;
+}
+
+/**
+ * Define a class that splits CSV text into records of fields
+ * Quoted fields may hold commas, doubled quotes and newlines. Records end
+ * with LF or CRLF, the last one may have no line ending
+ */
+class CsvTokenizer {
+
+private:
+    const char* position;
+    const char* end;
+
+    // the special characters of the 64 bytes starting at blockStart
+    const char* blockStart;
+    uint64_t blockBits;
+
+    const char* nextSpecial(const char* from);
+
+public:
+    CsvTokenizer(const char* begin, const char* end);
+    bool NextRecord(vector<CsvField>& fields);
+};
+
+/**
+ * Start at the first record of a range of text
+ *
+ * @param begin First character of the range, the start of a record
+ * @param end One past the last character of the range
+ */
+CsvTokenizer::CsvTokenizer(const char* begin, const char* end) {
+    position = begin;
+    this->end = end;
+    blockStart = end;
+    blockBits = 0;
+}
+
+/**
+ * Find the first comma, quote or newline at or after a position
+ * The mask of a block is computed once and used for every field in it
+ *
+ * @param from Position to search from
+ * @return the character found, or end
+ */
+const char* CsvTokenizer::nextSpecial(const char* from) {
+    while (from < end) {
+        if (from < blockStart || from - blockStart >= 64) {
+            blockStart = from;
+            blockBits = csvSpecialBits(from, end);
+        }
+        uint64_t bits = blockBits & (~0ULL << (from - blockStart));
+        if (bits != 0) {
+            return blockStart + lowestSetBit(bits);
+        }
+        from = blockStart + 64;
+    }
+    return end;
+}
+
+/**
+ * Split the next record into fields
+ *
+ * @param fields Vector that receives the fields, pointing into the text
+ * @return false when there are no records left
+ */
+bool CsvTokenizer::NextRecord(vector<CsvField>& fields) {
+    fields.clear();
+    if (position >= end) {
+        return false;
+    }
+
+    while (true) {
+        CsvField field;
+        field.escaped = false;
+        const char* delimiter;
+
+        if (position < end && *position == '"') {
+            // the field runs to the closing quote, a doubled quote is a quote in the value
+            const char* start = position + 1;
+            const char* quote = static_cast<const char*>(memchr(start, '"', end - start));
+            while (quote != nullptr && quote + 1 < end && quote[1] == '"') {
+                field.escaped = true;
+                quote = static_cast<const char*>(memchr(quote + 2, '"', end - (quote + 2)));
+            }
+            if (quote == nullptr) {
+                quote = end;
+            }
+            field.text = string_view(start, quote - start);
+
+            // anything between the closing quote and the delimiter, such as the \r of CRLF, is dropped
+            delimiter = (quote < end) ? quote + 1 : end;
+            while (delimiter < end && *delimiter != ',' && *delimiter != '\n') {
+                delimiter += 1;
+            }
+        }
+        else {
+            // a quote inside an unquoted field is kept as it is
+            delimiter = nextSpecial(position);
+            while (delimiter < end && *delimiter == '"') {
+                delimiter = nextSpecial(delimiter + 1);
+            }
+            field.text = string_view(position, delimiter - position);
+
+            // drop the carriage return of CRLF records
+            if (!field.text.empty() && field.text.back() == '\r' && (delimiter == end || *delimiter == '\n')) {
+                field.text.remove_suffix(1);
+            }
+        }
+        fields.push_back(field);
+
+        // a newline or the end of the text ends the record
+        if (delimiter == end || *delimiter == '\n') {
+            position = (delimiter == end) ? end : delimiter + 1;
+            return true;
+        }
+        position = delimiter + 1;
+    }
+}
+
+/*
+Function to find where a record ends, for splitting CSV text between records
+A newline ends a record only outside quotes. The quotes are followed from the
+start of a record with the rules of the tokenizer: a quote opens a quoted
+field only at the start of a field, and a doubled quote inside one is a quote
+@param: first character of a record, position to look for the end from, end of the text
+@return: one past the first record ending at or after the position, or nullptr if the text ends first
+*/
+const char* findCsvRecordEnd(const char* recordStart, const char* from, const char* end) {
+    const char* p = recordStart;
+    bool fieldStart = true;
+    while (p < end) {
+
+        // skip a quoted field to its closing quote
+        if (fieldStart && *p == '"') {
+            const char* quote = static_cast<const char*>(memchr(p + 1, '"', end - (p + 1)));
+            while (quote != nullptr && quote + 1 < end && quote[1] == '"') {
+                quote = static_cast<const char*>(memchr(quote + 2, '"', end - (quote + 2)));
+            }
+            if (quote == nullptr) {
+                return nullptr;
+            }
+            p = quote + 1;
+            fieldStart = false;
+            continue;
+        }
+
+        // any other quote is part of the field
+        p = findCsvSpecial(p, end);
+        if (p == end) {
+            return nullptr;
+        }
+        if (*p == '\n' && p >= from) {
+            return p + 1;
+        }
+        fieldStart = *p != '"';
+        p += 1;
+    }
+    return nullptr;
+}
+
+/*
+Function to copy a field into an uppercase string
+@param: field to copy
+*/
+string toUpperCopy(const CsvField& field) {
+    string result = csvFieldString(field);
+    transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+/**
+ * Parse a range of CSV text holding one course per record
+ * Fields are tokenized as string_views into the text, strings are only
+ * created for the values kept in the course. A quoted name may hold commas
+ *
+ * @param begin First character of the range
+ * @param end One past the last character of the range
+ * @param courses Vector that receives every course with a name
+ * @param courseIds Vector that receives the ID of every course added
+ * @param messages Stream that receives the error messages for skipped lines
+ */
+void parseCourses(const char* begin, const char* end, vector<Course>& courses, vector<string>& courseIds, ostream& messages) {
+    CsvTokenizer tokenizer(begin, end);
+    vector<CsvField> fields;
+
+    // iterate over the text one record at a time, a quoted field may span lines
+    while (tokenizer.NextRecord(fields)) {
+
+        // skip blank lines
+        if (fields.size() == 1 && fields[0].text.empty()) {
+            continue;
+        }
+
+        // create a temporary course object to add to the course list
+        Course tempCourse;
+
+        // the fields are the course ID, the course name, then prerequisites
+        for (int column = 0; column < (int)fields.size(); column++) {
+            const CsvField& field = fields[column];
+
+            // uppercase course IDs for consistency and comparison logic
+            if (column == 0) {
+                tempCourse.courseId = toUpperCopy(field);
+            }
+            else if (column == 1) {
+                tempCourse.name = csvFieldString(field);
+            }
+
+            // prerequisites are kept as is, they are validated once all IDs are known
+            else if (!field.text.empty()) {
+                tempCourse.prereq.push_back(toUpperCopy(field));
+            }
+        }
+
+        // send an error message if there is not a course name included in the line
+        if (tempCourse.name.empty()) {
+            messages << tempCourse.courseId << " does not have a name, and was not added to the course list." << '\n';
+            continue;
+        }
+
+        // keep the course and its ID
+        courseIds.push_back(tempCourse.courseId);
+        courses.push_back(std::move(tempCourse));
+    }
+}
+
+/**
+ * Drop every prerequisite that is not in the course list
+ *
+ * @param courses Courses whose prerequisites are checked
+ * @param begin First course to check
+ * @param end One past the last course to check
+ * @param courseIndex Index of the IDs of every course loaded
+ * @param unresolved Vector that receives a description of each dropped prerequisite
+ */
+void validatePrerequisites(vector<Course>& courses, int begin, int end, const CourseIdIndex& courseIndex, vector<string>& unresolved) {
+    for (int i = begin; i < end; i++) {
+        vector<string>& prereq = courses[i].prereq;
+
+        // keep the valid prerequisites at the front, in their original order
+        int kept = 0;
+        for (int j = 0; j < (int)prereq.size(); j++) {
+
+            // search for the prerequisite course in the course list
+            if (courseIndex.Find(prereq[j]) != -1) {
+                if (kept != j) {
+                    prereq[kept] = std::move(prereq[j]);
+                }
+                kept += 1;
+            }
+            else {
+                // remember the prerequisite that is not in the list of courses
+                unresolved.push_back(prereq[j] + " (prerequisite for " + courses[i].courseId + ")");
+            }
+        }
+        prereq.resize(kept);
+    }
+}
+
+/**
+ * Read a CSV file containing Courses into a vector sorted by course ID
+ * The file is mapped once and split at record boundaries into one chunk per
+ * thread, each thread finding and checking the start of its own chunk. Each
+ * thread parses its chunk into its own buffers, the buffers are merged in
+ * file order, and the course IDs are indexed, prerequisites are validated and
+ * the courses are sorted with the same threads
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param courseList vector that receives the courses
+ * @param threadCount number of threads to parse with, 0 uses one per core
+ * @return false if the file could not be opened
+ */
+bool readCourses(string csvPath, vector<Course>& courseList, int threadCount) {
+
+    // map the file of course information
+    MappedFile csvFile;
+    if (!csvFile.Open(csvPath)) {
+        cout << "Could not open " << csvPath << endl;
+        return false;
+    }
+    const char* text = csvFile.Data();
+    size_t textSize = csvFile.Size();
+    STATS_END_PHASE("map file");
+
+    // use one thread per core, but small files are not worth splitting
+    const size_t MIN_CHUNK_SIZE = 1 << 20;
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+    threadCount = (int)max((size_t)1, min((size_t)threadCount, textSize / MIN_CHUNK_SIZE));
+
+    // each thread starts its chunk after the first newline in its share of the file
+    vector<size_t> chunkStart(threadCount + 1, textSize);
+    chunkStart[0] = 0;
+    runParallel(threadCount, [&](int chunk) {
+        if (chunk > 0) {
+            size_t position = textSize / threadCount * chunk;
+            const char* newline = static_cast<const char*>(memchr(text + position, '\n', textSize - position));
+            chunkStart[chunk] = (newline == nullptr) ? textSize : (size_t)(newline + 1 - text);
+        }
+    });
+
+    // a newline inside a quoted field does not end a record, so each thread follows the
+    // quotes of its chunk from its start to check that the chunk ends where the next one starts
+    vector<char> endsOnRecord(threadCount, 1);
+    runParallel(threadCount, [&](int chunk) {
+        size_t end = chunkStart[chunk + 1];
+        if (end > chunkStart[chunk] && end < textSize) {
+            endsOnRecord[chunk] = findCsvRecordEnd(text + chunkStart[chunk], text + end - 1, text + textSize) == text + end;
+        }
+    });
+
+    // from the first chunk that does not, split the rest of the file one chunk after another
+    int firstWrong = (int)(find(endsOnRecord.begin(), endsOnRecord.end(), 0) - endsOnRecord.begin());
+    for (int i = firstWrong + 1; i < threadCount; i++) {
+        size_t position = max(chunkStart[i - 1], textSize / threadCount * i);
+        const char* recordEnd = findCsvRecordEnd(text + chunkStart[i - 1], text + position, text + textSize);
+        chunkStart[i] = (recordEnd == nullptr) ? textSize : (size_t)(recordEnd - text);
+    }
+
+    // each thread parses its chunk into its own buffers
+    vector<vector<Course>> chunkCourses(threadCount);
+    vector<vector<string>> chunkIds(threadCount);
+    vector<ostringstream> chunkMessages(threadCount);
+    runParallel(threadCount, [&](int chunk) {
+        parseCourses(text + chunkStart[chunk], text + chunkStart[chunk + 1], chunkCourses[chunk], chunkIds[chunk], chunkMessages[chunk]);
+    });
+    csvFile.Close();
+
+    // merge the buffers in file order, each thread moves its own buffer into place
+    vector<int> chunkOffset(threadCount + 1, 0);
+    for (int i = 0; i < threadCount; i++) {
+        cout << chunkMessages[i].str();
+        chunkMessages[i].str("");
+        chunkOffset[i + 1] = chunkOffset[i] + (int)chunkCourses[i].size();
+    }
+    courseList.clear();
+    courseList.resize(chunkOffset[threadCount]);
+    vector<string> courseIdVector(chunkOffset[threadCount]);
+    runParallel(threadCount, [&](int chunk) {
+        move(chunkCourses[chunk].begin(), chunkCourses[chunk].end(), courseList.begin() + chunkOffset[chunk]);
+        move(chunkIds[chunk].begin(), chunkIds[chunk].end(), courseIdVector.begin() + chunkOffset[chunk]);
+        vector<Course>().swap(chunkCourses[chunk]);
+        vector<string>().swap(chunkIds[chunk]);
+    });
+    STATS_END_PHASE("parse, ID scan");
+
+    // index the course IDs for resolving prerequisites, the index needs no order
+    CourseIdIndex courseIndex;
+    courseIndex.Build(std::move(courseIdVector), threadCount);
+
+    // keep the first course of each ID, the one the index points to
+    vector<vector<int>> chunkRepeated(threadCount);
+    runParallel(threadCount, [&](int chunk) {
+        for (int i = chunkOffset[chunk]; i < chunkOffset[chunk + 1]; i++) {
+            if (courseIndex.Find(courseList[i].courseId) != i) {
+                chunkRepeated[chunk].push_back(i);
+            }
+        }
+    });
+
+    // report the repeated courses in one batch and drop them
+    vector<int> repeated;
+    for (int chunk = 0; chunk < threadCount; chunk++) {
+        repeated.insert(repeated.end(), chunkRepeated[chunk].begin(), chunkRepeated[chunk].end());
+    }
+    if (!repeated.empty()) {
+        cout << repeated.size() << " courses were not added because their course ID appears earlier in the file:" << '\n';
+        for (int i = 0; i < (int)repeated.size(); i++) {
+            cout << "    " << courseList[repeated[i]].courseId << '\n';
+        }
+        int kept = 0;
+        size_t next = 0;
+        for (int i = 0; i < (int)courseList.size(); i++) {
+            if (next < repeated.size() && repeated[next] == i) {
+                next += 1;
+                continue;
+            }
+            if (kept != i) {
+                courseList[kept] = std::move(courseList[i]);
+            }
+            kept += 1;
+        }
+        courseList.resize(kept);
+    }
+    STATS_END_PHASE("index IDs");
+
+    // now that all IDs are known, make sure every prerequisite is a course
+    int courseCount = (int)courseList.size();
+    vector<vector<string>> chunkUnresolved(threadCount);
+    runParallel(threadCount, [&](int chunk) {
+        int begin = (int)((long long)courseCount * chunk / threadCount);
+        int end = (int)((long long)courseCount * (chunk + 1) / threadCount);
+        validatePrerequisites(courseList, begin, end, courseIndex, chunkUnresolved[chunk]);
+    });
+
+    // report every prerequisite that was dropped in one batch
+    int unresolvedCount = 0;
+    for (int i = 0; i < threadCount; i++) {
+        unresolvedCount += (int)chunkUnresolved[i].size();
+    }
+    if (unresolvedCount > 0) {
+        cout << unresolvedCount << " prerequisites were not added because they are not found in the course list:" << '\n';
+        for (int i = 0; i < threadCount; i++) {
+            for (int j = 0; j < (int)chunkUnresolved[i].size(); j++) {
+                cout << "    " << chunkUnresolved[i][j] << '\n';
+            }
+        }
+    }
+
+    STATS_END_PHASE("validate");
+
+    // sort the courses once by course ID
+    sortCoursesById(courseList, threadCount);
+    STATS_END_PHASE("sort courses");
+    return true;
+}
+
+/**
+ * Load a CSV file containing Courses into a container
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param catalog the catalog that receives the courses
+ * @param threadCount number of threads to parse with, 0 uses one per core
+ */
+void loadCourses(string csvPath, Catalog* catalog, int threadCount = 0) {
+    std::cout << "Loading CSV file " << csvPath << "..." << endl;
+    STATS_START_PHASES();
+
+    // read the courses, sorted by course ID
+    vector<Course> courseList;
+    if (!readCourses(csvPath, courseList, threadCount)) {
+        return;
+    }
+
+    // build the catalog from the sorted courses
+    catalog->BuildFromSorted(courseList);
+    STATS_END_PHASE("insert");
+
+    // resolve the prerequisites to course numbers and precompute their closure while loading
+    catalog->TransitivePrerequisites();
+    STATS_END_PHASE("prerequisites");
+
+    // index the course names for searching
+    catalog->NameIndex();
+    STATS_END_PHASE("name index");
+
+    // output the number of courses loaded from file
+    cout << catalog->Size() << " courses loaded from file." << endl;
+
+}
+
+/**
+ * Reload a CSV file into a catalog that already holds an earlier version of it
+ * The file is compared course by course with the catalog, and only the courses
+ * that were added, changed or removed are applied, each in O(log n) for the tree
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param catalog the catalog holding the earlier version
+ * @param threadCount number of threads to parse with, 0 uses one per core
+ */
+void reloadCourses(string csvPath, Catalog* catalog, int threadCount = 0) {
+    std::cout << "Reloading CSV file " << csvPath << "..." << endl;
+
+    // read the courses, sorted by course ID
+    vector<Course> courseList;
+    if (!readCourses(csvPath, courseList, threadCount)) {
+        return;
+    }
+
+    // walk the tree and the file side by side, both are in course ID order
+    vector<string> removedIds;
+    vector<int> added;
+    vector<int> changed;
+    int unchanged = 0;
+    Catalog::iterator it = catalog->begin();
+    int next = 0;
+    while (it != catalog->end() || next < (int)courseList.size()) {
+
+        // compare the current course of each side, running out of one side makes the other smaller
+        int result = 0;
+        if (it == catalog->end()) {
+            result = 1;
+        }
+        else if (next == (int)courseList.size()) {
+            result = -1;
+        }
+        else {
+            result = it->courseId.compare(courseList[next].courseId);
+        }
+
+        // only in the tree, it was removed from the file
+        if (result < 0) {
+            removedIds.push_back(it->courseId);
+            ++it;
+        }
+
+        // only in the file, it is new
+        else if (result > 0) {
+            added.push_back(next);
+            next += 1;
+        }
+
+        // in both, update it if the name or prerequisites differ
+        else {
+            if (it->name != courseList[next].name || it->prereq != courseList[next].prereq) {
+                changed.push_back(next);
+            }
+            else {
+                unchanged += 1;
+            }
+            ++it;
+            next += 1;
+        }
+    }
+
+    // apply the differences now that the walk is done
+    for (int i = 0; i < (int)removedIds.size(); i++) {
+        catalog->Remove(removedIds[i]);
+    }
+    for (int i = 0; i < (int)added.size(); i++) {
+        catalog->Insert(std::move(courseList[added[i]]));
+    }
+    for (int i = 0; i < (int)changed.size(); i++) {
+        catalog->Upsert(std::move(courseList[changed[i]]));
+    }
+
+    // rebuild the closure, components that did not change are reused
+    catalog->TransitivePrerequisites();
+    catalog->NameIndex();
+
+    // output what changed
+    cout << added.size() << " courses added, " << changed.size() << " updated, " << removedIds.size() << " removed, " << unchanged << " unchanged." << endl;
+}
+// function for printing classes in alphanumerical order
+// the listing is rendered once per version of the catalog and written in one piece
+template<typename Storage>
+void CourseCatalog<Storage>::printSampleSchedule(ostream& out) {
+    const string& text = renderedListing();
+    out.write(text.data(), text.size());
+}
+
+/*
+Function for printing every course whose ID starts with a prefix
+@param: prefix of the course IDs, stream to print to
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printCoursesWithPrefix(string prefix, ostream& out) {
+    transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+
+    vector<const Course*> courses = PrefixQuery(prefix);
+    if (courses.empty()) {
+        out << "No course found with prefix " << prefix << '\n';
+        return;
+    }
+    for (int i = 0; i < (int)courses.size(); i++) {
+        out << courses[i]->courseId << ", " << courses[i]->name << '\n';
+    }
+}
+
+/*
+Function for printing every course with an ID between two IDs, both included
+@param: first and last course ID of the range, stream to print to
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printCoursesInRange(string lowId, string highId, ostream& out) {
+    vector<const Course*> courses = RangeQuery(lowId, highId);
+    for (int i = 0; i < (int)courses.size(); i++) {
+        out << courses[i]->courseId << ", " << courses[i]->name << '\n';
+    }
+}
+
+/*
+Function for printing every course whose name holds each word of a query
+@param: words to search the course names for, stream to print to
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printNameSearch(string query, ostream& out) {
+    vector<const Course*> courses = SearchNames(query);
+    if (courses.empty()) {
+        out << "No course found matching " << query << '\n';
+        return;
+    }
+    for (int i = 0; i < (int)courses.size(); i++) {
+        out << courses[i]->courseId << ", " << courses[i]->name << '\n';
+    }
+}
+
+// function for printing classes term by term, each after its prerequisites
+template<typename Storage>
+void CourseCatalog<Storage>::printPrerequisiteSchedule(ostream& out) {
+    PrerequisiteGraph().printSchedule(out);
+}
+
+/*
+Function for printing every course required before a course
+@param: courseId to list the prerequisites of, stream to print to
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printAllPrerequisites(string courseId, ostream& out) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    // make sure the course exists
+    if (storage.Find(courseId) == nullptr) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    vector<string> prereqs = AllPrerequisites(courseId);
+    if (prereqs.empty()) {
+        out << courseId << " has no prerequisites." << '\n';
+        return;
+    }
+
+    // output the prerequisites separated by commas
+    out << "All prerequisites for " << courseId << ": ";
+    for (int i = 0; i < (int)prereqs.size(); i++) {
+        if (i > 0) {
+            out << ", ";
+        }
+        out << prereqs[i];
+    }
+    out << '\n';
+}
+
+
+/*
+Function for printing a specific course based on input course ID
+@param: courseId for search, stream to print to
+
+*/
+template<typename Storage>
+void CourseCatalog<Storage>::printCourseInformation(string courseId, ostream& out) {
+
+    // transform input to uppercase for compariosn
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    // find the course, through the frozen index when the storage has one
+    STATS_TIMER(lookupStart);
+    const Course* curCourse = storage.Find(courseId);
+    STATS_RECORD_LOOKUP(lookupStart);
+
+    // return statement for any input that does not have a matching course Id
+    if (curCourse == nullptr) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    // write the detail block rendered for this version of the catalog
+    string_view block = renderedCourse(curCourse);
+    out.write(block.data(), block.size());
+}
+
+//============================================================================
+// Catalog snapshot class definition
+//============================================================================
+
+/**
+ * Define a class that saves a loaded catalog to a binary snapshot and
+ * answers queries straight from the mapped snapshot file
+ *
+ * Layout (host byte order, every section 16 byte aligned):
+ *   header      SnapshotHeader
+ *   strings     course IDs and names, back to back
+ *   records     one SnapshotRecord per course, in course ID order
+ *   prereqs     uint32 course numbers, the prerequisites of every course
+ *   lookup keys CourseKey per Eytzinger slot, slot 0 unused
+ *   lookup map  uint32 course number per Eytzinger slot
+ * Opening a snapshot maps the file, checks the header and checks every
+ * offset, range and course number in one pass, so queries can trust them.
+ * Nothing is parsed or allocated per course
+ */
+class CatalogSnapshot {
+
+private:
+    static const uint32_t VERSION = 1;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t courseCount;
+        uint32_t prereqCount;
+        uint64_t stringOffset;
+        uint64_t stringSize;
+        uint64_t recordOffset;
+        uint64_t prereqOffset;
+        uint64_t lookupKeyOffset;
+        uint64_t lookupMapOffset;
+        uint64_t fileSize;
+    };
+
+    struct SnapshotRecord {
+        CourseKey key;
+        uint32_t idOffset;
+        uint32_t idLength;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t prereqStart;
+        uint32_t prereqCount;
+    };
+
+    MappedFile file;
+    const SnapshotHeader* header;
+    const char* strings;
+    const SnapshotRecord* records;
+    const uint32_t* prereqs;
+    const CourseKey* lookupKeys;
+    const uint32_t* lookupMap;
+
+    // built from the mapped arrays the first time they are needed
+    bool graphBuilt;
+    CourseGraph graph;
+    bool closureBuilt;
+    PrerequisiteClosure closure;
+    bool nameIndexBuilt;
+    CourseNameIndex nameIndex;
+
+    static bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t limit);
+    bool validate() const;
+    string_view stringAt(uint32_t offset, uint32_t length) const;
+    string_view courseId(int course) const;
+    string_view courseName(int course) const;
+    int lowerBound(const string& courseId) const;
+    const CourseGraph& prerequisiteGraph();
+
+public:
+    CatalogSnapshot();
+    static bool Save(const CourseGraph& catalog, const string& path);
+    bool Open(const string& path);
+    int Size() const;
+    int Find(string courseId) const;
+    void printCourseInformation(string courseId, ostream& out = cout);
+    void printSampleSchedule(ostream& out = cout);
+    void printPrerequisiteSchedule(ostream& out = cout);
+    void printAllPrerequisites(string courseId, ostream& out = cout);
+    void printCoursesWithPrefix(string prefix, ostream& out = cout);
+    void printCoursesInRange(string lowId, string highId, ostream& out = cout);
+    void printNameSearch(string query, ostream& out = cout);
+};
+
+/**
+ * Default constructor
+ */
+CatalogSnapshot::CatalogSnapshot() {
+    header = nullptr;
+    strings = nullptr;
+    records = nullptr;
+    prereqs = nullptr;
+    lookupKeys = nullptr;
+    lookupMap = nullptr;
+    graphBuilt = false;
+    closureBuilt = false;
+    nameIndexBuilt = false;
+}
+
+/**
+ * Write a catalog to a snapshot file
+ *
+ * @param catalog Prerequisite graph of the catalog, holding every course in course ID order
+ * @param path Path of the snapshot file
+ * @return false if the file could not be written
+ */
+bool CatalogSnapshot::Save(const CourseGraph& catalog, const string& path) {
+    int count = catalog.Size();
+
+    // sections start on 16 byte boundaries
+    auto align = [](uint64_t offset) {
+        return (offset + 15) & ~(uint64_t)15;
+    };
+
+    // lay out the string pool and the records
+    vector<SnapshotRecord> recordList(count);
+    uint64_t stringSize = 0;
+    for (int i = 0; i < count; i++) {
+        SnapshotRecord& record = recordList[i];
+        record.key = CourseKey(catalog.courseIds[i]);
+        record.idOffset = (uint32_t)stringSize;
+        record.idLength = (uint32_t)catalog.courseIds[i].size();
+        stringSize += record.idLength;
+        record.nameOffset = (uint32_t)stringSize;
+        record.nameLength = (uint32_t)catalog.courseNames[i].size();
+        stringSize += record.nameLength;
+        record.prereqStart = (uint32_t)catalog.prereqStart[i];
+        record.prereqCount = (uint32_t)(catalog.prereqStart[i + 1] - catalog.prereqStart[i]);
+    }
+
+    // string offsets are 32 bits
+    if (stringSize > UINT32_MAX) {
+        cout << "The catalog is too large for a snapshot." << endl;
+        return false;
+    }
+
+    // fill in the header
+    SnapshotHeader head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, "ABCUCAT", 8);
+    head.version = VERSION;
+    head.byteOrder = BYTE_ORDER_MARK;
+    head.courseCount = (uint32_t)count;
+    head.prereqCount = (uint32_t)catalog.prereqList.size();
+    head.stringOffset = align(sizeof(SnapshotHeader));
+    head.stringSize = stringSize;
+    head.recordOffset = align(head.stringOffset + stringSize);
+    head.prereqOffset = align(head.recordOffset + (uint64_t)count * sizeof(SnapshotRecord));
+    head.lookupKeyOffset = align(head.prereqOffset + (uint64_t)head.prereqCount * sizeof(uint32_t));
+    head.lookupMapOffset = align(head.lookupKeyOffset + (uint64_t)(count + 1) * sizeof(CourseKey));
+    head.fileSize = head.lookupMapOffset + (uint64_t)(count + 1) * sizeof(uint32_t);
+
+    // the lookup index in its final Eytzinger layout
+    vector<int> layout = eytzingerLayout(count);
+    vector<CourseKey> keys(count + 1);
+    vector<uint32_t> map(count + 1, 0);
+    for (int slot = 1; slot <= count; slot++) {
+        keys[slot] = recordList[layout[slot]].key;
+        map[slot] = (uint32_t)layout[slot];
+    }
+    vector<uint32_t> prereqList(catalog.prereqList.begin(), catalog.prereqList.end());
+
+    ofstream output(path, ios::binary | ios::trunc);
+    if (!output.good()) {
+        cout << "Could not write " << path << endl;
+        return false;
+    }
+
+    // write each section, padding up to its offset
+    auto writeAt = [&output](uint64_t offset, const void* data, size_t size) {
+        static const char padding[16] = { 0 };
+        uint64_t position = (uint64_t)output.tellp();
+        output.write(padding, (streamsize)(offset - position));
+        output.write(static_cast<const char*>(data), (streamsize)size);
+    };
+    writeAt(0, &head, sizeof(head));
+    writeAt(head.stringOffset, "", 0);
+    for (int i = 0; i < count; i++) {
+        output.write(catalog.courseIds[i].data(), (streamsize)catalog.courseIds[i].size());
+        output.write(catalog.courseNames[i].data(), (streamsize)catalog.courseNames[i].size());
+    }
+    writeAt(head.recordOffset, recordList.data(), recordList.size() * sizeof(SnapshotRecord));
+    writeAt(head.prereqOffset, prereqList.data(), prereqList.size() * sizeof(uint32_t));
+    writeAt(head.lookupKeyOffset, keys.data(), keys.size() * sizeof(CourseKey));
+    writeAt(head.lookupMapOffset, map.data(), map.size() * sizeof(uint32_t));
+    output.close();
+    return !output.fail();
+}
+
+/**
+ * Check that a section of count elements starting at an offset ends by a limit,
+ * without overflowing on a damaged count or offset
+ *
+ * @param offset Start of the section in the file
+ * @param count Number of elements in the section
+ * @param elementSize Size of one element
+ * @param limit Offset the section must end by
+ */
+bool CatalogSnapshot::sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t limit) {
+    return offset <= limit && count <= (limit - offset) / elementSize;
+}
+
+/**
+ * Check every record and lookup slot of a mapped snapshot, O(n)
+ * Each string range must lie in the string pool, each prerequisite range in
+ * the prerequisite section, and each prerequisite and lookup slot must name a course
+ *
+ * @return false if anything points outside the snapshot
+ */
+bool CatalogSnapshot::validate() const {
+    uint32_t count = header->courseCount;
+    for (uint32_t i = 0; i < count; i++) {
+        const SnapshotRecord& record = records[i];
+        if ((uint64_t)record.idOffset + record.idLength > header->stringSize
+            || (uint64_t)record.nameOffset + record.nameLength > header->stringSize
+            || (uint64_t)record.prereqStart + record.prereqCount > header->prereqCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->prereqCount; i++) {
+        if (prereqs[i] >= count) {
+            return false;
+        }
+    }
+
+    // slot 0 of the lookup index is unused
+    for (uint32_t slot = 1; slot <= count; slot++) {
+        if (lookupMap[slot] >= count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Map a snapshot file
+ * The header and every record are checked, the courses are used where they
+ * lie in the file
+ *
+ * @param path Path of the snapshot file
+ * @return false if the file is missing, damaged or not a snapshot of this version
+ */
+bool CatalogSnapshot::Open(const string& path) {
+    graphBuilt = false;
+    closureBuilt = false;
+    nameIndexBuilt = false;
+    header = nullptr;
+    if (!file.Open(path) || file.Size() < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    // check the header against this build and the file
+    const SnapshotHeader* head = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    uint64_t count = head->courseCount;
+    if (memcmp(head->magic, "ABCUCAT", 8) != 0 || head->version != VERSION || head->byteOrder != BYTE_ORDER_MARK
+        || head->fileSize != file.Size() || count > (uint64_t)INT32_MAX) {
+        file.Close();
+        return false;
+    }
+
+    // the sections are 16 byte aligned, in order, and each ends before the next starts
+    uint64_t offsets[5] = { head->stringOffset, head->recordOffset, head->prereqOffset, head->lookupKeyOffset, head->lookupMapOffset };
+    for (int i = 0; i < 5; i++) {
+        if (offsets[i] % 16 != 0) {
+            file.Close();
+            return false;
+        }
+    }
+    if (head->stringOffset < sizeof(SnapshotHeader)
+        || !sectionFits(head->stringOffset, head->stringSize, 1, head->recordOffset)
+        || !sectionFits(head->recordOffset, count, sizeof(SnapshotRecord), head->prereqOffset)
+        || !sectionFits(head->prereqOffset, head->prereqCount, sizeof(uint32_t), head->lookupKeyOffset)
+        || !sectionFits(head->lookupKeyOffset, count + 1, sizeof(CourseKey), head->lookupMapOffset)
+        || !sectionFits(head->lookupMapOffset, count + 1, sizeof(uint32_t), head->fileSize)) {
+        file.Close();
+        return false;
+    }
+
+    // point every section into the mapping
+    header = head;
+    strings = file.Data() + head->stringOffset;
+    records = reinterpret_cast<const SnapshotRecord*>(file.Data() + head->recordOffset);
+    prereqs = reinterpret_cast<const uint32_t*>(file.Data() + head->prereqOffset);
+    lookupKeys = reinterpret_cast<const CourseKey*>(file.Data() + head->lookupKeyOffset);
+    lookupMap = reinterpret_cast<const uint32_t*>(file.Data() + head->lookupMapOffset);
+
+    // a snapshot pointing outside itself is not used at all
+    if (!validate()) {
+        header = nullptr;
+        file.Close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Text from the string pool, Open has checked that the range is inside it
+ */
+string_view CatalogSnapshot::stringAt(uint32_t offset, uint32_t length) const {
+    return string_view(strings + offset, length);
+}
+
+/**
+ * ID of a course
+ *
+ * @param course Course number
+ */
+string_view CatalogSnapshot::courseId(int course) const {
+    return stringAt(records[course].idOffset, records[course].idLength);
+}
+
+/**
+ * Name of a course
+ *
+ * @param course Course number
+ */
+string_view CatalogSnapshot::courseName(int course) const {
+    return stringAt(records[course].nameOffset, records[course].nameLength);
+}
+
+/**
+ * Number of courses in the snapshot
+ */
+int CatalogSnapshot::Size() const {
+    return (header == nullptr) ? 0 : (int)header->courseCount;
+}
+
+/**
+ * Find a course through the Eytzinger lookup index
+ *
+ * @param courseId Course ID to find
+ * @return the course number, or -1 if the course is not in the snapshot
+ */
+int CatalogSnapshot::Find(string courseId) const {
+    if (Size() == 0) {
+        return -1;
+    }
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    int slot = eytzingerFind(lookupKeys, Size(), CourseKey(courseId), courseId, [this](int at) {
+        return this->courseId(lookupMap[at]);
+    });
+    return (slot != 0) ? (int)lookupMap[slot] : -1;
+}
+
+/**
+ * First course whose ID is not less than an ID, by binary search over the records
+ *
+ * @param courseId Uppercase course ID
+ * @return the course number, Size() when every ID is smaller
+ */
+int CatalogSnapshot::lowerBound(const string& courseId) const {
+    CourseKey key(courseId);
+    int low = 0;
+    int high = Size();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compareCourseIds(records[mid].key, this->courseId(mid), key, courseId) < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Prerequisite graph viewing the mapped strings, built on first use
+ */
+const CourseGraph& CatalogSnapshot::prerequisiteGraph() {
+    if (!graphBuilt) {
+        int count = Size();
+        graph = CourseGraph();
+        graph.courseIds.resize(count);
+        graph.courseNames.resize(count);
+        graph.prereqStart.assign(count + 1, 0);
+        for (int i = 0; i < count; i++) {
+            graph.courseIds[i] = courseId(i);
+            graph.courseNames[i] = courseName(i);
+            for (uint32_t j = 0; j < records[i].prereqCount; j++) {
+                graph.prereqList.push_back((int)prereqs[records[i].prereqStart + j]);
+            }
+            graph.prereqStart[i + 1] = (int)graph.prereqList.size();
+        }
+        graphBuilt = true;
+    }
+    return graph;
+}
+
+/*
+Function for printing every course whose name holds each word of a query
+@param: words to search the course names for, stream to print to
+*/
+void CatalogSnapshot::printNameSearch(string query, ostream& out) {
+    // the index is built the first time it is asked for
+    if (!nameIndexBuilt) {
+        nameIndex.Build(prerequisiteGraph());
+        nameIndexBuilt = true;
+    }
+    vector<int> found = nameIndex.Search(query);
+    if (found.empty()) {
+        out << "No course found matching " << query << '\n';
+        return;
+    }
+    for (int i = 0; i < (int)found.size(); i++) {
+        out << courseId(found[i]) << ", " << courseName(found[i]) << '\n';
+    }
+}
+
+/*
+Function for printing a specific course based on input course ID
+@param: courseId for search, stream to print to
+*/
+void CatalogSnapshot::printCourseInformation(string courseId, ostream& out) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    int course = Find(courseId);
+    if (course == -1) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    //output course Id, course name
+    out << this->courseId(course) << ", " << courseName(course) << '\n';
+
+    //iterate over prerequisite list, printing off each prerequisite
+    const SnapshotRecord& record = records[course];
+    for (uint32_t i = 0; i < record.prereqCount; i++) {
+        out << ((i == 0) ? "Prerequisites: " : ", ");
+        out << this->courseId(prereqs[record.prereqStart + i]);
+    }
+    out << '\n';
+}
+
+// function for printing classes in alphanumerical order
+void CatalogSnapshot::printSampleSchedule(ostream& out) {
+    for (int i = 0; i < Size(); i++) {
+        out << courseId(i) << ", " << courseName(i) << '\n';
+    }
+}
+
+// function for printing classes term by term, each after its prerequisites
+void CatalogSnapshot::printPrerequisiteSchedule(ostream& out) {
+    prerequisiteGraph().printSchedule(out);
+}
+
+/*
+Function for printing every course required before a course
+@param: courseId to list the prerequisites of, stream to print to
+*/
+void CatalogSnapshot::printAllPrerequisites(string courseId, ostream& out) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    int course = Find(courseId);
+    if (course == -1) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    // the closure is computed the first time it is asked for
+    if (!closureBuilt) {
+        closure.Build(prerequisiteGraph());
+        closureBuilt = true;
+    }
+    vector<int> found = closure.AllPrerequisites(course);
+    if (found.empty()) {
+        out << courseId << " has no prerequisites." << '\n';
+        return;
+    }
+
+    // output the prerequisites separated by commas
+    out << "All prerequisites for " << courseId << ": ";
+    for (int i = 0; i < (int)found.size(); i++) {
+        if (i > 0) {
+            out << ", ";
+        }
+        out << this->courseId(found[i]);
+    }
+    out << '\n';
+}
+
+/*
+Function for printing every course whose ID starts with a prefix
+@param: prefix of the course IDs, stream to print to
+*/
+void CatalogSnapshot::printCoursesWithPrefix(string prefix, ostream& out) {
+    transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+
+    // the matching IDs are contiguous, starting at the prefix itself
+    int printed = 0;
+    for (int i = lowerBound(prefix); i < Size() && courseId(i).compare(0, prefix.size(), prefix) == 0; i++) {
+        out << courseId(i) << ", " << courseName(i) << '\n';
+        printed += 1;
+    }
+    if (printed == 0) {
+        out << "No course found with prefix " << prefix << '\n';
+    }
+}
+
+/*
+Function for printing every course with an ID between two IDs, both included
+@param: first and last course ID of the range, stream to print to
+*/
+void CatalogSnapshot::printCoursesInRange(string lowId, string highId, ostream& out) {
+    transform(lowId.begin(), lowId.end(), lowId.begin(), ::toupper);
+    transform(highId.begin(), highId.end(), highId.begin(), ::toupper);
+
+    CourseKey highKey(highId);
+    for (int i = lowerBound(lowId); i < Size() && compareCourseIds(records[i].key, courseId(i), highKey, highId) <= 0; i++) {
+        out << courseId(i) << ", " << courseName(i) << '\n';
+    }
+}
+
+//============================================================================
+// Page cache class definition
+//============================================================================
+
+/**
+ * Define a class that keeps a bounded number of fixed size pages of a file
+ * in memory
+ *
+ * Pages are read on first use and written back when they are evicted or the
+ * cache is flushed. Eviction uses the clock algorithm: each frame has a
+ * referenced bit that is set on use, and the hand clears bits until it finds
+ * a frame that was not used since its last pass. A pinned page is never
+ * evicted, so a pointer to it stays valid until it is unpinned.
+ */
+class PageCache {
+
+public:
+    static const int PAGE_SIZE = 4096;
+    static const uint32_t NO_PAGE = UINT32_MAX;
+
+    // the tree pins at most a page and its new sibling at once
+    static const int MIN_FRAMES = 8;
+
+private:
+    struct Frame {
+        uint32_t page;
+        int pins;
+        bool dirty;
+        bool referenced;
+    };
+
+    fstream file;
+    uint32_t pageCount;
+
+    // one page of memory per frame, and the frame holding each cached page
+    vector<char> memory;
+    vector<Frame> frames;
+    unordered_map<uint32_t, int> frameOf;
+    int hand;
+
+    // counters for the --stats report
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t pageWrites;
+
+    char* frameData(int frame);
+    int claimFrame();
+    bool writeFrame(int frame);
+
+public:
+    PageCache();
+    ~PageCache();
+    PageCache(const PageCache&) = delete;
+    PageCache& operator=(const PageCache&) = delete;
+    bool Open(const string& path, size_t cacheBytes, bool create);
+    void Close();
+    char* Pin(uint32_t page);
+    char* PinNew(uint32_t& page);
+    void Unpin(uint32_t page, bool dirty);
+    bool Flush();
+    uint32_t PageCount() const;
+    size_t CacheBytes() const;
+    void printStats(ostream& out);
+};
+
+/**
+ * Default constructor
+ */
+PageCache::PageCache() {
+    pageCount = 0;
+    hand = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+    pageWrites = 0;
+}
+
+/**
+ * Destructor, writes back every changed page
+ */
+PageCache::~PageCache() {
+    Close();
+}
+
+/**
+ * Open a page file
+ *
+ * @param path Path of the file
+ * @param cacheBytes Memory to keep pages in, at least MIN_FRAMES pages are kept
+ * @param create true to start an empty file, replacing any file at the path
+ * @return true if the file could be opened
+ */
+bool PageCache::Open(const string& path, size_t cacheBytes, bool create) {
+    Close();
+    if (create) {
+        file.open(path, ios::in | ios::out | ios::binary | ios::trunc);
+    }
+    else {
+        file.open(path, ios::in | ios::out | ios::binary);
+    }
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // the file holds whole pages
+    file.seekg(0, ios::end);
+    pageCount = (uint32_t)((uint64_t)file.tellg() / PAGE_SIZE);
+
+    // every frame starts empty
+    int frameCount = (int)max((size_t)MIN_FRAMES, cacheBytes / PAGE_SIZE);
+    memory.assign((size_t)frameCount * PAGE_SIZE, 0);
+    frames.assign(frameCount, Frame{ NO_PAGE, 0, false, false });
+    frameOf.clear();
+    frameOf.reserve(frameCount * 2);
+    hand = 0;
+    return true;
+}
+
+/**
+ * Write back every changed page and close the file
+ */
+void PageCache::Close() {
+    if (file.is_open()) {
+        Flush();
+        file.close();
+    }
+    vector<char>().swap(memory);
+    frames.clear();
+    frameOf.clear();
+    pageCount = 0;
+}
+
+/**
+ * First byte of the page held by a frame
+ */
+char* PageCache::frameData(int frame) {
+    return memory.data() + (size_t)frame * PAGE_SIZE;
+}
+
+/**
+ * Find a frame to load a page into, evicting the page it holds
+ * Clock: sweep the frames, giving each recently used page a second chance
+ *
+ * @return the frame, now empty, or -1 if every frame is pinned
+ */
+int PageCache::claimFrame() {
+    int frameCount = (int)frames.size();
+    for (int step = 0; step < frameCount * 2; step++) {
+        int frame = hand;
+        hand = (hand + 1) % frameCount;
+        Frame& candidate = frames[frame];
+        if (candidate.pins > 0) {
+            continue;
+        }
+        if (candidate.referenced) {
+            candidate.referenced = false;
+            continue;
+        }
+
+        // write the page back before the frame is reused
+        if (candidate.page != NO_PAGE) {
+            if (candidate.dirty && !writeFrame(frame)) {
+                return -1;
+            }
+            frameOf.erase(candidate.page);
+            evictions += 1;
+        }
+        candidate.page = NO_PAGE;
+        candidate.dirty = false;
+        return frame;
+    }
+    return -1;
+}
+
+/**
+ * Write the page held by a frame to the file
+ */
+bool PageCache::writeFrame(int frame) {
+    file.seekp((streamoff)frames[frame].page * PAGE_SIZE);
+    file.write(frameData(frame), PAGE_SIZE);
+    if (!file.good()) {
+        return false;
+    }
+    frames[frame].dirty = false;
+    pageWrites += 1;
+    return true;
+}
+
+/**
+ * Pin a page in memory, reading it from the file if it is not cached
+ *
+ * @param page Page number
+ * @return the page, valid until it is unpinned, or nullptr if it cannot be read
+ */
+char* PageCache::Pin(uint32_t page) {
+    auto found = frameOf.find(page);
+    if (found != frameOf.end()) {
+        Frame& frame = frames[found->second];
+        frame.pins += 1;
+        frame.referenced = true;
+        hits += 1;
+        return frameData(found->second);
+    }
+
+    // read the page into a free frame
+    misses += 1;
+    if (page >= pageCount) {
+        return nullptr;
+    }
+    int frame = claimFrame();
+    if (frame == -1) {
+        return nullptr;
+    }
+    file.seekg((streamoff)page * PAGE_SIZE);
+    file.read(frameData(frame), PAGE_SIZE);
+    if (!file.good()) {
+        file.clear();
+        return nullptr;
+    }
+    frames[frame] = Frame{ page, 1, false, true };
+    frameOf[page] = frame;
+    return frameData(frame);
+}
+
+/**
+ * Add a zeroed page to the end of the file and pin it
+ * The page reaches the file when it is evicted or flushed
+ *
+ * @param page Receives the number of the new page
+ * @return the page, or nullptr if every frame is pinned
+ */
+char* PageCache::PinNew(uint32_t& page) {
+    int frame = claimFrame();
+    if (frame == -1) {
+        return nullptr;
+    }
+    page = pageCount;
+    pageCount += 1;
+    memset(frameData(frame), 0, PAGE_SIZE);
+    frames[frame] = Frame{ page, 1, true, true };
+    frameOf[page] = frame;
+    return frameData(frame);
+}
+
+/**
+ * Unpin a page
+ *
+ * @param page Page number
+ * @param dirty true if the page was changed while it was pinned
+ */
+void PageCache::Unpin(uint32_t page, bool dirty) {
+    auto found = frameOf.find(page);
+    if (found != frameOf.end()) {
+        Frame& frame = frames[found->second];
+        frame.pins -= 1;
+        frame.dirty = frame.dirty || dirty;
+    }
+}
+
+/**
+ * Write every changed page to the file
+ *
+ * @return true if every page was written
+ */
+bool PageCache::Flush() {
+    bool written = true;
+    for (int i = 0; i < (int)frames.size(); i++) {
+        if (frames[i].page != NO_PAGE && frames[i].dirty) {
+            written = writeFrame(i) && written;
+        }
+    }
+    file.flush();
+    return written && file.good();
+}
+
+/**
+ * Number of pages in the file, including pages not yet written back
+ */
+uint32_t PageCache::PageCount() const {
+    return pageCount;
+}
+
+/**
+ * Bytes of memory held for pages
+ */
+size_t PageCache::CacheBytes() const {
+    return memory.size();
+}
+
+/**
+ * Print the size and hit rate of the cache
+ *
+ * @param out Stream to print to
+ */
+void PageCache::printStats(ostream& out) {
+    out << "Page cache: " << frames.size() << " frames of " << PAGE_SIZE << " bytes, " << hits << " hits, "
+        << misses << " misses, " << evictions << " evictions, " << pageWrites << " page writes" << '\n';
+}
+
+//============================================================================
+// Paged course tree class definition
+//============================================================================
+
+/**
+ * Define a B+tree of courses kept in a file of fixed size pages, for
+ * catalogs larger than memory
+ *
+ * Only the pages in the page cache are in memory, so the memory used is set
+ * by the cache size rather than the number of courses. Courses live in the
+ * leaves in course ID order and every leaf links to the next, so ordered
+ * listings read the leaves one after another without going back up the
+ * tree. Internal pages hold separator IDs: the subtree right of a separator
+ * holds the IDs at or after it.
+ *
+ * Every page is slotted: a header, an array of slots growing from the front,
+ * and the records the slots point to growing from the back. A leaf record is
+ * a course: ID, name and prerequisites, each prefixed by a 16 bit length. An
+ * internal record is a 32 bit child page followed by the separator ID.
+ * Page 0 holds the file header, so page number 0 also marks a missing page.
+ */
+class PagedCourseTree {
+
+private:
+    static const uint32_t VERSION = 1;
+    static const uint16_t LEAF_PAGE = 1;
+    static const uint16_t INTERNAL_PAGE = 2;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t pageSize;
+        uint32_t rootPage;
+        uint32_t height;
+        uint32_t courseCount;
+    };
+
+    struct PageHeader {
+        uint16_t type;
+        uint16_t count;
+        uint16_t freeEnd;
+        uint16_t unused;
+        uint32_t next;
+        uint32_t first;
+    };
+
+    struct Slot {
+        uint16_t offset;
+        uint16_t length;
+    };
+
+    // at least four records fit in a page, so a split always leaves both halves non-empty
+    static const int MAX_RECORD = (PageCache::PAGE_SIZE - (int)sizeof(PageHeader)) / 4 - (int)sizeof(Slot);
+
+    PageCache cache;
+    bool isOpen;
+    uint32_t rootPage;
+    uint32_t height;
+    uint32_t courseCount;
+
+    static PageHeader* pageHeader(char* page);
+    static Slot* slots(char* page);
+    static string_view record(char* page, int i);
+    static string_view recordKey(char* page, int i);
+    static uint32_t recordChild(char* page, int i);
+    static void initPage(char* page, uint16_t type);
+    static bool placeRecord(char* page, int position, string_view bytes);
+    static void removeRecord(char* page, int position);
+    static int lowerBound(char* page, string_view courseId);
+    static int upperBound(char* page, string_view courseId);
+    static uint32_t childFor(char* page, string_view courseId);
+    static string encodeCourse(const Course& course);
+    static void decodeCourse(string_view bytes, Course& course);
+    bool splitPage(char* page, int position, string_view bytes, string& separator, uint32_t& rightPage);
+    int insertInto(uint32_t pageNumber, const string& courseId, const string& bytes, string& separator, uint32_t& rightPage);
+    bool writeHeader();
+
+public:
+    PagedCourseTree();
+    ~PagedCourseTree();
+    PagedCourseTree(const PagedCourseTree&) = delete;
+    PagedCourseTree& operator=(const PagedCourseTree&) = delete;
+    bool Create(const string& path, size_t cacheBytes);
+    bool Open(const string& path, size_t cacheBytes);
+    bool Flush();
+    bool Insert(const Course& course);
+    bool Find(string courseId, Course& course);
+    void Scan(string lowId, const function<bool(const Course&)>& visit);
+    int Size() const;
+    void printCourseInformation(string courseId, ostream& out = cout);
+    void printSampleSchedule(ostream& out = cout);
+    void printPrerequisiteSchedule(ostream& out = cout);
+    void printAllPrerequisites(string courseId, ostream& out = cout);
+    void printCoursesWithPrefix(string prefix, ostream& out = cout);
+    void printCoursesInRange(string lowId, string highId, ostream& out = cout);
+    void printNameSearch(string query, ostream& out = cout);
+    void printStats(ostream& out);
+};
+
+/**
+ * Default constructor
+ */
+PagedCourseTree::PagedCourseTree() {
+    isOpen = false;
+    rootPage = 0;
+    height = 0;
+    courseCount = 0;
+}
+
+/**
+ * Destructor, writes the tree back to its file
+ */
+PagedCourseTree::~PagedCourseTree() {
+    Flush();
+}
+
+/**
+ * Header at the start of a page
+ */
+PagedCourseTree::PageHeader* PagedCourseTree::pageHeader(char* page) {
+    return reinterpret_cast<PageHeader*>(page);
+}
+
+/**
+ * Slot array of a page, right after the header
+ */
+PagedCourseTree::Slot* PagedCourseTree::slots(char* page) {
+    return reinterpret_cast<Slot*>(page + sizeof(PageHeader));
+}
+
+/**
+ * Bytes of a record of a page
+ */
+string_view PagedCourseTree::record(char* page, int i) {
+    const Slot& slot = slots(page)[i];
+    return string_view(page + slot.offset, slot.length);
+}
+
+/**
+ * Course ID a record of a page is ordered by
+ */
+string_view PagedCourseTree::recordKey(char* page, int i) {
+    string_view bytes = record(page, i);
+    if (pageHeader(page)->type == INTERNAL_PAGE) {
+        return bytes.substr(sizeof(uint32_t));
+    }
+    uint16_t length;
+    memcpy(&length, bytes.data(), sizeof(length));
+    return bytes.substr(sizeof(length), length);
+}
+
+/**
+ * Child page of a record of an internal page
+ */
+uint32_t PagedCourseTree::recordChild(char* page, int i) {
+    uint32_t child;
+    memcpy(&child, record(page, i).data(), sizeof(child));
+    return child;
+}
+
+/**
+ * Make a page an empty page of a type
+ */
+void PagedCourseTree::initPage(char* page, uint16_t type) {
+    PageHeader* header = pageHeader(page);
+    header->type = type;
+    header->count = 0;
+    header->freeEnd = PageCache::PAGE_SIZE;
+    header->unused = 0;
+    header->next = 0;
+    header->first = 0;
+}
+
+/**
+ * Put a record into a page at a slot position
+ * Space left by removed records is reclaimed by compacting the page when needed
+ *
+ * @param page Page to add to
+ * @param position Slot the record goes in, later slots move up one
+ * @param bytes Record to add
+ * @return false if the page is too full, it is left unchanged
+ */
+bool PagedCourseTree::placeRecord(char* page, int position, string_view bytes) {
+    PageHeader* header = pageHeader(page);
+    int slotEnd = (int)sizeof(PageHeader) + (header->count + 1) * (int)sizeof(Slot);
+
+    // compact the page if the gap between the slots and the records is too small
+    if (header->freeEnd - slotEnd < (int)bytes.size()) {
+        int live = 0;
+        for (int i = 0; i < header->count; i++) {
+            live += slots(page)[i].length;
+        }
+        if (PageCache::PAGE_SIZE - slotEnd - live < (int)bytes.size()) {
+            return false;
+        }
+        char copy[PageCache::PAGE_SIZE];
+        memcpy(copy, page, PageCache::PAGE_SIZE);
+        int freeEnd = PageCache::PAGE_SIZE;
+        for (int i = 0; i < header->count; i++) {
+            string_view moved = record(copy, i);
+            freeEnd -= (int)moved.size();
+            memcpy(page + freeEnd, moved.data(), moved.size());
+            slots(page)[i].offset = (uint16_t)freeEnd;
+        }
+        header->freeEnd = (uint16_t)freeEnd;
+    }
+
+    // copy the record in and open a slot for it
+    header->freeEnd = (uint16_t)(header->freeEnd - bytes.size());
+    memcpy(page + header->freeEnd, bytes.data(), bytes.size());
+    Slot* slot = slots(page);
+    memmove(slot + position + 1, slot + position, (header->count - position) * sizeof(Slot));
+    slot[position].offset = header->freeEnd;
+    slot[position].length = (uint16_t)bytes.size();
+    header->count += 1;
+    return true;
+}
+
+/**
+ * Drop a record from a page, its bytes are reclaimed by the next compaction
+ */
+void PagedCourseTree::removeRecord(char* page, int position) {
+    PageHeader* header = pageHeader(page);
+    Slot* slot = slots(page);
+    memmove(slot + position, slot + position + 1, (header->count - position - 1) * sizeof(Slot));
+    header->count -= 1;
+}
+
+/**
+ * First slot of a page whose ID is at or after a course ID
+ */
+int PagedCourseTree::lowerBound(char* page, string_view courseId) {
+    int low = 0;
+    int high = pageHeader(page)->count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (recordKey(page, middle) < courseId) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * First slot of a page whose ID is after a course ID
+ */
+int PagedCourseTree::upperBound(char* page, string_view courseId) {
+    int low = 0;
+    int high = pageHeader(page)->count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (recordKey(page, middle) <= courseId) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Child of an internal page whose subtree holds a course ID
+ */
+uint32_t PagedCourseTree::childFor(char* page, string_view courseId) {
+    int position = upperBound(page, courseId);
+    return (position == 0) ? pageHeader(page)->first : recordChild(page, position - 1);
+}
+
+/**
+ * Serialize a course into a leaf record
+ */
+string PagedCourseTree::encodeCourse(const Course& course) {
+    string bytes;
+    auto append = [&bytes](string_view text) {
+        uint16_t length = (uint16_t)min(text.size(), (size_t)UINT16_MAX);
+        bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        bytes.append(text.data(), length);
+    };
+    append(course.courseId);
+    append(course.name);
+    uint16_t count = (uint16_t)course.prereq.size();
+    bytes.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (int i = 0; i < (int)count; i++) {
+        append(course.prereq[i]);
+    }
+    return bytes;
+}
+
+/**
+ * Read a course back from a leaf record
+ * The strings of the course are reused, so decoding many records into one
+ * course allocates little
+ */
+void PagedCourseTree::decodeCourse(string_view bytes, Course& course) {
+    size_t position = 0;
+    auto take = [&bytes, &position]() {
+        uint16_t length;
+        memcpy(&length, bytes.data() + position, sizeof(length));
+        string_view text = bytes.substr(position + sizeof(length), length);
+        position += sizeof(length) + length;
+        return text;
+    };
+    string_view text = take();
+    course.courseId.assign(text.data(), text.size());
+    text = take();
+    course.name.assign(text.data(), text.size());
+    uint16_t count;
+    memcpy(&count, bytes.data() + position, sizeof(count));
+    position += sizeof(count);
+    course.prereq.resize(count);
+    for (int i = 0; i < (int)count; i++) {
+        text = take();
+        course.prereq[i].assign(text.data(), text.size());
+    }
+}
+
+/**
+ * Split a full page in two while adding a record to it
+ * The page keeps the first half, a new page to its right takes the rest
+ *
+ * @param page Pinned page that is too full for the record
+ * @param position Slot the record goes in
+ * @param bytes Record to add
+ * @param separator Receives the first ID of the right page
+ * @param rightPage Receives the number of the right page
+ * @return false if no page could be added
+ */
+bool PagedCourseTree::splitPage(char* page, int position, string_view bytes, string& separator, uint32_t& rightPage) {
+    PageHeader* header = pageHeader(page);
+    bool leaf = header->type == LEAF_PAGE;
+
+    // every record in order, with the new one in its place
+    vector<string> records;
+    records.reserve(header->count + 1);
+    for (int i = 0; i < header->count; i++) {
+        if (i == position) {
+            records.push_back(string(bytes));
+        }
+        records.push_back(string(record(page, i)));
+    }
+    if (position == header->count) {
+        records.push_back(string(bytes));
+    }
+
+    // split where half the bytes are on each side
+    size_t total = 0;
+    for (int i = 0; i < (int)records.size(); i++) {
+        total += records[i].size() + sizeof(Slot);
+    }
+    int middle = 0;
+    size_t leftBytes = 0;
+    while (middle < (int)records.size() - 2 && leftBytes + records[middle].size() + sizeof(Slot) <= total / 2) {
+        leftBytes += records[middle].size() + sizeof(Slot);
+        middle += 1;
+    }
+    middle = max(middle, 1);
+
+    char* right = cache.PinNew(rightPage);
+    if (right == nullptr) {
+        return false;
+    }
+    initPage(right, header->type);
+
+    // a leaf copies its middle ID up, an internal page moves it up and its child becomes the right page's first
+    int rightStart = middle;
+    if (leaf) {
+        uint16_t length;
+        memcpy(&length, records[middle].data(), sizeof(length));
+        separator = records[middle].substr(sizeof(length), length);
+        pageHeader(right)->next = header->next;
+        header->next = rightPage;
+    }
+    else {
+        memcpy(&pageHeader(right)->first, records[middle].data(), sizeof(uint32_t));
+        separator = records[middle].substr(sizeof(uint32_t));
+        rightStart = middle + 1;
+    }
+    for (int i = rightStart; i < (int)records.size(); i++) {
+        placeRecord(right, i - rightStart, records[i]);
+    }
+
+    // rebuild the left half in place
+    uint32_t next = header->next;
+    uint32_t first = header->first;
+    initPage(page, leaf ? LEAF_PAGE : INTERNAL_PAGE);
+    pageHeader(page)->next = next;
+    pageHeader(page)->first = first;
+    for (int i = 0; i < middle; i++) {
+        placeRecord(page, i, records[i]);
+    }
+    cache.Unpin(rightPage, true);
+    return true;
+}
+
+/**
+ * Add a leaf record below a page (recursive)
+ * Only the page being changed and a new sibling are pinned at any time
+ *
+ * @param pageNumber Page to add below
+ * @param courseId ID of the course
+ * @param bytes Leaf record of the course
+ * @param separator Receives the separator if the page split
+ * @param rightPage Receives the new right page if the page split, else 0
+ * @return 1 if a course was added, 0 if one was replaced, -1 on an I/O error
+ */
+int PagedCourseTree::insertInto(uint32_t pageNumber, const string& courseId, const string& bytes, string& separator, uint32_t& rightPage) {
+    rightPage = 0;
+    char* page = cache.Pin(pageNumber);
+    if (page == nullptr) {
+        return -1;
+    }
+
+    int added = 1;
+    int position = 0;
+    string record = bytes;
+    if (pageHeader(page)->type == INTERNAL_PAGE) {
+
+        // descend with the page unpinned, it is only needed again if the child splits
+        uint32_t child = childFor(page, courseId);
+        cache.Unpin(pageNumber, false);
+        string childSeparator;
+        uint32_t childRight = 0;
+        added = insertInto(child, courseId, bytes, childSeparator, childRight);
+        if (added == -1 || childRight == 0) {
+            return added;
+        }
+
+        // the child split, so the new right page needs a separator here
+        page = cache.Pin(pageNumber);
+        if (page == nullptr) {
+            return -1;
+        }
+        record.assign(reinterpret_cast<const char*>(&childRight), sizeof(childRight));
+        record += childSeparator;
+        position = upperBound(page, childSeparator);
+    }
+    else {
+        // a course with the same ID is replaced
+        position = lowerBound(page, courseId);
+        if (position < pageHeader(page)->count && recordKey(page, position) == courseId) {
+            removeRecord(page, position);
+            added = 0;
+        }
+    }
+
+    // add the record, splitting the page if it is full
+    if (!placeRecord(page, position, record) && !splitPage(page, position, record, separator, rightPage)) {
+        added = -1;
+    }
+    cache.Unpin(pageNumber, true);
+    return added;
+}
+
+/**
+ * Write the root, height and course count to the file header
+ */
+bool PagedCourseTree::writeHeader() {
+    char* page = cache.Pin(0);
+    if (page == nullptr) {
+        return false;
+    }
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "ABCUBPT", 8);
+    header.version = VERSION;
+    header.pageSize = PageCache::PAGE_SIZE;
+    header.rootPage = rootPage;
+    header.height = height;
+    header.courseCount = courseCount;
+    memcpy(page, &header, sizeof(header));
+    cache.Unpin(0, true);
+    return true;
+}
+
+/**
+ * Start an empty tree in a new file
+ *
+ * @param path Path of the file, an existing file is replaced
+ * @param cacheBytes Memory to keep pages in
+ * @return true if the file could be created
+ */
+bool PagedCourseTree::Create(const string& path, size_t cacheBytes) {
+    isOpen = false;
+    if (!cache.Open(path, cacheBytes, true)) {
+        cout << "Could not create " << path << endl;
+        return false;
+    }
+
+    // page 0 is the file header, page 1 the first leaf
+    uint32_t headerPage;
+    uint32_t leafPage;
+    cache.PinNew(headerPage);
+    cache.Unpin(headerPage, true);
+    initPage(cache.PinNew(leafPage), LEAF_PAGE);
+    cache.Unpin(leafPage, true);
+    rootPage = leafPage;
+    height = 1;
+    courseCount = 0;
+    isOpen = writeHeader();
+    return isOpen;
+}
+
+/**
+ * Open a tree saved by an earlier run
+ *
+ * @param path Path of the file
+ * @param cacheBytes Memory to keep pages in
+ * @return true if the file holds a tree this build can read
+ */
+bool PagedCourseTree::Open(const string& path, size_t cacheBytes) {
+    isOpen = false;
+    if (!cache.Open(path, cacheBytes, false)) {
+        return false;
+    }
+    char* page = cache.Pin(0);
+    if (page == nullptr) {
+        return false;
+    }
+    FileHeader header;
+    memcpy(&header, page, sizeof(header));
+    cache.Unpin(0, false);
+
+    // the file must be a tree of this version and page size, with its root in the file
+    if (memcmp(header.magic, "ABCUBPT", 8) != 0 || header.version != VERSION || header.pageSize != PageCache::PAGE_SIZE
+        || header.rootPage == 0 || header.rootPage >= cache.PageCount() || header.height == 0) {
+        cache.Close();
+        return false;
+    }
+    rootPage = header.rootPage;
+    height = header.height;
+    courseCount = header.courseCount;
+    isOpen = true;
+    return true;
+}
+
+/**
+ * Write every changed page and the header to the file
+ */
+bool PagedCourseTree::Flush() {
+    if (!isOpen) {
+        return false;
+    }
+    return writeHeader() && cache.Flush();
+}
+
+/**
+ * Insert a course, replacing a course with the same ID
+ * O(log n) pages are read, and each page split adds one page
+ *
+ * @param course Course to insert
+ * @return false if the course is too large for a page or the file could not be written
+ */
+bool PagedCourseTree::Insert(const Course& course) {
+    string bytes = encodeCourse(course);
+    if (!isOpen || (int)bytes.size() > MAX_RECORD) {
+        return false;
+    }
+
+    string separator;
+    uint32_t rightPage = 0;
+    int added = insertInto(rootPage, course.courseId, bytes, separator, rightPage);
+    if (added == -1) {
+        return false;
+    }
+    courseCount += added;
+
+    // the root split, so a new root holds the two halves
+    if (rightPage != 0) {
+        uint32_t newRoot;
+        char* page = cache.PinNew(newRoot);
+        if (page == nullptr) {
+            return false;
+        }
+        initPage(page, INTERNAL_PAGE);
+        pageHeader(page)->first = rootPage;
+        string record(reinterpret_cast<const char*>(&rightPage), sizeof(rightPage));
+        record += separator;
+        placeRecord(page, 0, record);
+        cache.Unpin(newRoot, true);
+        rootPage = newRoot;
+        height += 1;
+    }
+    return true;
+}
+
+/**
+ * Find a course by course ID, reading one page per level
+ *
+ * @param courseId Course ID to find, in any case
+ * @param course Receives the course
+ * @return true if the course was found
+ */
+bool PagedCourseTree::Find(string courseId, Course& course) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+    if (!isOpen) {
+        return false;
+    }
+
+    // descend to the leaf that would hold the course
+    uint32_t pageNumber = rootPage;
+    char* page = cache.Pin(pageNumber);
+    while (page != nullptr && pageHeader(page)->type == INTERNAL_PAGE) {
+        uint32_t child = childFor(page, courseId);
+        cache.Unpin(pageNumber, false);
+        pageNumber = child;
+        page = cache.Pin(pageNumber);
+    }
+    if (page == nullptr) {
+        return false;
+    }
+
+    int position = lowerBound(page, courseId);
+    bool found = position < pageHeader(page)->count && recordKey(page, position) == courseId;
+    if (found) {
+        decodeCourse(record(page, position), course);
+    }
+    cache.Unpin(pageNumber, false);
+    return found;
+}
+
+/**
+ * Visit the courses in course ID order, starting at a course ID
+ * The leaves are read through their links, one page pinned at a time
+ *
+ * @param lowId First course ID to visit, in any case, "" for every course
+ * @param visit Function called with each course, returns false to stop
+ */
+void PagedCourseTree::Scan(string lowId, const function<bool(const Course&)>& visit) {
+    transform(lowId.begin(), lowId.end(), lowId.begin(), ::toupper);
+    if (!isOpen) {
+        return;
+    }
+
+    // descend to the leaf that would hold the first course
+    uint32_t pageNumber = rootPage;
+    char* page = cache.Pin(pageNumber);
+    while (page != nullptr && pageHeader(page)->type == INTERNAL_PAGE) {
+        uint32_t child = childFor(page, lowId);
+        cache.Unpin(pageNumber, false);
+        pageNumber = child;
+        page = cache.Pin(pageNumber);
+    }
+
+    // walk the leaves to the right
+    Course course;
+    int position = (page != nullptr) ? lowerBound(page, lowId) : 0;
+    while (page != nullptr) {
+        for (int i = position; i < pageHeader(page)->count; i++) {
+            decodeCourse(record(page, i), course);
+            if (!visit(course)) {
+                cache.Unpin(pageNumber, false);
+                return;
+            }
+        }
+        uint32_t next = pageHeader(page)->next;
+        cache.Unpin(pageNumber, false);
+        if (next == 0) {
+            return;
+        }
+        pageNumber = next;
+        page = cache.Pin(pageNumber);
+        position = 0;
+    }
+}
+
+/**
+ * Number of courses in the tree
+ */
+int PagedCourseTree::Size() const {
+    return (int)courseCount;
+}
+
+/*
+Function for printing a specific course based on input course ID
+@param: courseId for search, stream to print to
+*/
+void PagedCourseTree::printCourseInformation(string courseId, ostream& out) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    Course course;
+    if (!Find(courseId, course)) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    //output course Id, course name
+    out << course.courseId << ", " << course.name << '\n';
+
+    //iterate over prerequisite list, printing off each prerequisite
+    for (int i = 0; i < (int)course.prereq.size(); i++) {
+        out << ((i == 0) ? "Prerequisites: " : ", ") << course.prereq[i];
+    }
+    out << '\n';
+}
+
+// function for printing classes in alphanumerical order
+void PagedCourseTree::printSampleSchedule(ostream& out) {
+    Scan("", [&out](const Course& course) {
+        out << course.courseId << ", " << course.name << '\n';
+        return true;
+    });
+}
+
+// the schedule orders the whole prerequisite graph, which only an in-memory catalog holds
+void PagedCourseTree::printPrerequisiteSchedule(ostream& out) {
+    out << "The prerequisite schedule needs the catalog in memory, load it without --paged." << '\n';
+}
+
+/*
+Function for printing every course required before a course
+The prerequisites are followed one lookup at a time, so only the courses
+found are held in memory
+@param: courseId to list the prerequisites of, stream to print to
+*/
+void PagedCourseTree::printAllPrerequisites(string courseId, ostream& out) {
+    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
+
+    Course course;
+    if (!Find(courseId, course)) {
+        out << "No course found with Id " << courseId << '\n';
+        return;
+    }
+
+    // depth first over the prerequisites, each course is looked up once
+    vector<string> found;
+    vector<string> stack(course.prereq.rbegin(), course.prereq.rend());
+    unordered_map<string, bool> seen;
+    seen[courseId] = true;
+    while (!stack.empty()) {
+        string prereq = std::move(stack.back());
+        stack.pop_back();
+        if (seen[prereq]) {
+            continue;
+        }
+        seen[prereq] = true;
+        if (Find(prereq, course)) {
+            found.push_back(prereq);
+            stack.insert(stack.end(), course.prereq.rbegin(), course.prereq.rend());
+        }
+    }
+    if (found.empty()) {
+        out << courseId << " has no prerequisites." << '\n';
+        return;
+    }
+
+    // output the prerequisites in course ID order separated by commas
+    sort(found.begin(), found.end());
+    out << "All prerequisites for " << courseId << ": ";
+    for (int i = 0; i < (int)found.size(); i++) {
+        if (i > 0) {
+            out << ", ";
+        }
+        out << found[i];
+    }
+    out << '\n';
+}
+
+/*
+Function for printing every course whose ID starts with a prefix
+@param: prefix of the course IDs, stream to print to
+*/
+void PagedCourseTree::printCoursesWithPrefix(string prefix, ostream& out) {
+    transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+
+    // the matching IDs are contiguous, starting at the prefix itself
+    int printed = 0;
+    Scan(prefix, [&](const Course& course) {
+        if (course.courseId.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        out << course.courseId << ", " << course.name << '\n';
+        printed += 1;
+        return true;
+    });
+    if (printed == 0) {
+        out << "No course found with prefix " << prefix << '\n';
+    }
+}
+
+/*
+Function for printing every course with an ID between two IDs, both included
+@param: first and last course ID of the range, stream to print to
+*/
+void PagedCourseTree::printCoursesInRange(string lowId, string highId, ostream& out) {
+    transform(lowId.begin(), lowId.end(), lowId.begin(), ::toupper);
+    transform(highId.begin(), highId.end(), highId.begin(), ::toupper);
+    Scan(lowId, [&](const Course& course) {
+        if (course.courseId > highId) {
+            return false;
+        }
+        out << course.courseId << ", " << course.name << '\n';
+        return true;
+    });
+}
+
+/*
+Function for printing every course whose name holds each word of a query
+The tree has no name index, so every leaf is read in order
+@param: words to search the course names for, stream to print to
+*/
+void PagedCourseTree::printNameSearch(string query, ostream& out) {
+    // lowercase the query and split it into terms
+    transform(query.begin(), query.end(), query.begin(), [](unsigned char c) {
+        return (char)tolower(c);
+    });
+    vector<string> terms;
+    stringstream stream(query);
+    string term;
+    while (stream >> term) {
+        terms.push_back(term);
+    }
+
+    int printed = 0;
+    if (!terms.empty()) {
+        string name;
+        Scan("", [&](const Course& course) {
+            name = course.name;
+            transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                return (char)tolower(c);
+            });
+            for (int i = 0; i < (int)terms.size(); i++) {
+                if (name.find(terms[i]) == string::npos) {
+                    return true;
+                }
+            }
+            out << course.courseId << ", " << course.name << '\n';
+            printed += 1;
+            return true;
+        });
+    }
+    if (printed == 0) {
+        out << "No course found matching " << query << '\n';
+    }
+}
+
+/**
+ * Print the size and shape of the tree and the page cache counters
+ *
+ * @param out Stream to print to
+ */
+void PagedCourseTree::printStats(ostream& out) {
+    out << "Paged B+tree: " << courseCount << " courses, height " << height << ", "
+        << cache.PageCount() << " pages of " << PageCache::PAGE_SIZE << " bytes, cache of " << cache.CacheBytes() << " bytes" << '\n';
+    cache.printStats(out);
+}
+
+/**
+ * Load a CSV file containing Courses into a paged tree
+ * The file is read in blocks and each course is inserted as it is parsed, so
+ * memory stays bounded by the block and the page cache. Prerequisites are
+ * checked against the tree afterwards, dropping the ones that are not courses
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param tree the tree that receives the courses
+ * @return false if the file could not be read, a course is too large for a
+ *         page, or the tree could not be written
+ */
+bool loadPagedCourses(string csvPath, PagedCourseTree* tree) {
+    std::cout << "Loading CSV file " << csvPath << " into a paged tree..." << endl;
+    ifstream csvFile(csvPath, ios::binary);
+    if (!csvFile.good()) {
+        cout << "Could not open " << csvPath << endl;
+        return false;
+    }
+
+    // read a block, parse the complete lines in it and carry the rest over
+    const size_t BLOCK_SIZE = 1 << 20;
+    vector<char> block;
+    vector<Course> courses;
+    vector<string> courseIds;
+    vector<string> repeatedIds;
+    vector<string> tooLargeIds;
+    Course found;
+    bool done = false;
+    while (!done) {
+        size_t carried = block.size();
+        block.resize(carried + BLOCK_SIZE);
+        csvFile.read(block.data() + carried, BLOCK_SIZE);
+        block.resize(carried + (size_t)csvFile.gcount());
+        done = !csvFile.good();
+
+        // the last block ends the last record even without a newline
+        size_t parsed = block.size();
+        if (!done) {
+            const char* text = block.data();
+            const char* recordEnd = text;
+            const char* next;
+            while ((next = findCsvRecordEnd(recordEnd, recordEnd, text + block.size())) != nullptr) {
+                recordEnd = next;
+            }
+            parsed = (size_t)(recordEnd - text);
+        }
+        parseCourses(block.data(), block.data() + parsed, courses, courseIds, cout);
+        for (int i = 0; i < (int)courses.size(); i++) {
+
+            // keep the first course of each ID, as the in-memory loader does
+            if (tree->Find(courses[i].courseId, found)) {
+                repeatedIds.push_back(courses[i].courseId);
+            }
+            else if (!tree->Insert(courses[i])) {
+                tooLargeIds.push_back(courses[i].courseId);
+            }
+        }
+        courses.clear();
+        courseIds.clear();
+        block.erase(block.begin(), block.begin() + parsed);
+    }
+    if (!repeatedIds.empty()) {
+        cout << repeatedIds.size() << " courses were not added because their course ID appears earlier in the file:" << '\n';
+        for (int i = 0; i < (int)repeatedIds.size(); i++) {
+            cout << "    " << repeatedIds[i] << '\n';
+        }
+    }
+
+    // a course that does not fit in a page leaves the tree incomplete, so the load fails
+    if (!tooLargeIds.empty()) {
+        cout << tooLargeIds.size() << " courses were not added because they are too large for a page or could not be written:" << '\n';
+        for (int i = 0; i < (int)tooLargeIds.size(); i++) {
+            cout << "    " << tooLargeIds[i] << '\n';
+        }
+        cout << "Could not load " << csvPath << " into the paged tree." << endl;
+        return false;
+    }
+
+    // now that all IDs are known, find the prerequisites that are not courses
+    vector<Course> fixed;
+    vector<string> unresolved;
+    tree->Scan("", [&](const Course& course) {
+        vector<string> kept;
+        for (int i = 0; i < (int)course.prereq.size(); i++) {
+            if (tree->Find(course.prereq[i], found)) {
+                kept.push_back(course.prereq[i]);
+            }
+            else {
+                unresolved.push_back(course.prereq[i] + " (prerequisite for " + course.courseId + ")");
+            }
+        }
+        if (kept.size() != course.prereq.size()) {
+            fixed.push_back(course);
+            fixed.back().prereq = kept;
+        }
+        return true;
+    });
+
+    // rewrite those courses now that the scan is done
+    for (int i = 0; i < (int)fixed.size(); i++) {
+        tree->Insert(fixed[i]);
+    }
+    if (!unresolved.empty()) {
+        cout << unresolved.size() << " prerequisites were not added because they are not found in the course list:" << '\n';
+        for (int i = 0; i < (int)unresolved.size(); i++) {
+            cout << "    " << unresolved[i] << '\n';
+        }
+    }
+
+    if (!tree->Flush()) {
+        cout << "Could not write the paged tree." << endl;
+        return false;
+    }
+    cout << tree->Size() << " courses loaded from file." << endl;
+    return true;
+}
+
+//============================================================================
+// Concurrent catalog class definition
+//============================================================================
+
+/**
+ * Define a class that lets many threads query the catalog while another
+ * thread reloads it
+ *
+ * Readers never take a lock: each one pins an epoch in a reader slot and
+ * queries the version of the catalog that was current when it started.
+ * A reload builds the next version off to the side, finishes every index
+ * the readers will touch, then swaps it in with one atomic exchange. The
+ * old version is retired with the epoch of the swap and deleted once no
+ * reader slot holds an earlier epoch.
+ */
+class ConcurrentCatalog {
+
+private:
+    static const int READER_SLOTS = 128;
+
+    struct Version {
+        Catalog courses;
+        uint64_t retireEpoch = 0;
+    };
+
+    // one cache line per slot so readers do not contend, 0 marks a free slot
+    struct alignas(64) ReaderSlot {
+        atomic<uint64_t> epoch;
+    };
+
+    atomic<Version*> current;
+    atomic<uint64_t> globalEpoch;
+    ReaderSlot slots[READER_SLOTS];
+
+    // writers are serialized, and only they touch the retired list
+    mutex writerLock;
+    vector<Version*> retired;
+
+    int pin();
+    void unpin(int slot);
+    void reclaim();
+    void publish(vector<Course>& courseList);
+
+public:
+    /**
+     * A pinned version of the catalog, valid until the reader is destroyed
+     * Only the query and print functions of the catalog may be called through it
+     */
+    class Reader {
+    private:
+        ConcurrentCatalog* catalog;
+        int slot;
+        Catalog* version;
+
+    public:
+        explicit Reader(ConcurrentCatalog* catalog);
+        Reader(Reader&& other) noexcept;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+        Catalog* operator->() const { return version; }
+        Catalog& operator*() const { return *version; }
+    };
+
+    ConcurrentCatalog();
+    ~ConcurrentCatalog();
+    ConcurrentCatalog(const ConcurrentCatalog&) = delete;
+    ConcurrentCatalog& operator=(const ConcurrentCatalog&) = delete;
+    Reader Read();
+    int Size();
+    void Publish(vector<Course>& courseList);
+    bool Reload(string csvPath, int threadCount = 0);
+    int RetiredVersions();
+};
+
+/**
+ * Default constructor, starts with an empty catalog
+ */
+ConcurrentCatalog::ConcurrentCatalog() {
+    Version* empty = new Version();
+    empty->courses.Freeze();
+    current.store(empty);
+    globalEpoch.store(1);
+    for (int i = 0; i < READER_SLOTS; i++) {
+        slots[i].epoch.store(0);
+    }
+}
+
+/**
+ * Destructor, every reader must be gone
+ */
+ConcurrentCatalog::~ConcurrentCatalog() {
+    delete current.load();
+    for (int i = 0; i < (int)retired.size(); i++) {
+        delete retired[i];
+    }
+}
+
+/**
+ * Claim a reader slot holding the current epoch
+ * Threads start looking at different slots, and wait only if every slot is taken
+ *
+ * @return the slot claimed
+ */
+int ConcurrentCatalog::pin() {
+    int start = (int)(hash<thread::id>()(this_thread::get_id()) % READER_SLOTS);
+    while (true) {
+        uint64_t epoch = globalEpoch.load();
+        for (int i = 0; i < READER_SLOTS; i++) {
+            int slot = (start + i) % READER_SLOTS;
+            uint64_t free = 0;
+            if (slots[slot].epoch.load(memory_order_relaxed) == 0
+                && slots[slot].epoch.compare_exchange_strong(free, epoch)) {
+                return slot;
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+/**
+ * Give a reader slot back
+ */
+void ConcurrentCatalog::unpin(int slot) {
+    slots[slot].epoch.store(0, memory_order_release);
+}
+
+/**
+ * Delete every retired version no reader can still hold
+ * A reader pinned at an epoch at or after a version's retire epoch loaded
+ * the catalog after the swap, so it never saw that version
+ * Called with the writer lock held
+ */
+void ConcurrentCatalog::reclaim() {
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < READER_SLOTS; i++) {
+        uint64_t epoch = slots[i].epoch.load();
+        if (epoch != 0) {
+            oldest = min(oldest, epoch);
+        }
+    }
+
+    // keep the versions that are still pinned
+    int kept = 0;
+    for (int i = 0; i < (int)retired.size(); i++) {
+        if (retired[i]->retireEpoch <= oldest) {
+            delete retired[i];
+        }
+        else {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+}
+
+/**
+ * Pin the current version of the catalog
+ */
+ConcurrentCatalog::Reader::Reader(ConcurrentCatalog* catalog) {
+    this->catalog = catalog;
+    slot = catalog->pin();
+
+    // loaded after the slot is published, so a writer that missed the slot swapped before this load
+    version = &catalog->current.load()->courses;
+}
+
+/**
+ * Move constructor, the slot moves with the reader
+ */
+ConcurrentCatalog::Reader::Reader(Reader&& other) noexcept {
+    catalog = other.catalog;
+    slot = other.slot;
+    version = other.version;
+    other.catalog = nullptr;
+}
+
+/**
+ * Destructor, unpins the version
+ */
+ConcurrentCatalog::Reader::~Reader() {
+    if (catalog != nullptr) {
+        catalog->unpin(slot);
+    }
+}
+
+/**
+ * Pin the current version of the catalog for queries
+ */
+ConcurrentCatalog::Reader ConcurrentCatalog::Read() {
+    return Reader(this);
+}
+
+/**
+ * Number of courses in the current version
+ */
+int ConcurrentCatalog::Size() {
+    return Read()->Size();
+}
+
+/**
+ * Build a new version from sorted courses and make it current
+ * Called with the writer lock held
+ *
+ * @param courseList Courses sorted by course ID, moved into the new version
+ */
+void ConcurrentCatalog::publish(vector<Course>& courseList) {
+    // build the version and every lazy index before any reader can see it
+    Version* next = new Version();
+    next->courses.BuildFromSorted(courseList);
+    next->courses.TransitivePrerequisites();
+    next->courses.NameIndex();
+    next->courses.Freeze();
+    next->courses.Render();
+
+    Version* previous = current.exchange(next);
+
+    // readers pinned from the new epoch on only see the new version
+    previous->retireEpoch = globalEpoch.fetch_add(1) + 1;
+    retired.push_back(previous);
+    reclaim();
+}
+
+/**
+ * Build a new version from sorted courses and make it current
+ *
+ * @param courseList Courses sorted by course ID, moved into the new version
+ */
+void ConcurrentCatalog::Publish(vector<Course>& courseList) {
+    lock_guard<mutex> lock(writerLock);
+    publish(courseList);
+}
+
+/**
+ * Read a CSV file into a new version of the catalog and make it current
+ * Readers keep answering from the previous version while the file loads.
+ * The writer lock is held from the parse on, so reloads run one at a time,
+ * publish in the order they started and never share the load counters
+ *
+ * @param csvPath Path of the CSV file of courses
+ * @param threadCount Number of threads to parse with, 0 to use every core
+ * @return false if the file could not be read, the current version is kept
+ */
+bool ConcurrentCatalog::Reload(string csvPath, int threadCount) {
+    lock_guard<mutex> lock(writerLock);
+    vector<Course> courseList;
+    if (!readCourses(csvPath, courseList, threadCount)) {
+        return false;
+    }
+    publish(courseList);
+    return true;
+}
+
+/**
+ * Number of replaced versions still waiting for their readers to finish
+ */
+int ConcurrentCatalog::RetiredVersions() {
+    lock_guard<mutex> lock(writerLock);
+    reclaim();
+    return (int)retired.size();
+}
+
+/*
+Function for printing the shape of the tree: height, average node depth and
+how far the nodes are from balanced
+@param: stream to print to
+*/
+void BinarySearchTree::printStats(ostream& out) {
+    // walk every node with its depth, the root is at depth 1
+    long long depthSum = 0;
+    int maxImbalance = 0;
+    int unbalanced = 0;
+    vector<pair<Node*, int>> stack;
+    if (root != nullptr) {
+        stack.push_back(make_pair(root, 1));
+    }
+    while (!stack.empty()) {
+        Node* node = stack.back().first;
+        int depth = stack.back().second;
+        stack.pop_back();
+        depthSum += depth;
+
+        // balance factor is the height difference of the two subtrees
+        int balance = abs(nodeHeight(node->left) - nodeHeight(node->right));
+        maxImbalance = max(maxImbalance, balance);
+        if (balance > 1) {
+            unbalanced += 1;
+        }
+        if (node->left != nullptr) {
+            stack.push_back(make_pair(node->left, depth + 1));
+        }
+        if (node->right != nullptr) {
+            stack.push_back(make_pair(node->right, depth + 1));
+        }
+    }
+
+    // the lowest possible height for this many nodes
+    int minHeight = 0;
+    while ((1LL << minHeight) - 1 < size) {
+        minHeight += 1;
+    }
+    out << "Tree: " << size << " courses, height " << Height() << " (lowest possible " << minHeight << ")" << '\n';
+    out << "Average node depth: " << fixed << setprecision(2) << ((size > 0) ? (double)depthSum / size : 0.0) << '\n';
+    out << "Largest balance factor: " << maxImbalance << ", nodes out of AVL balance: " << unbalanced << '\n';
+}
+
+/*
+Function to check if a file exists in the file structure
+@param: filename as string to validate exisitance
+*/
+bool fileExists(const std::string& filename) {
+    std::ifstream file(filename);
+
+    // return true (file exists) or false (file does not exist)
+    return file.good();
+}
+
+/*
+Function to check if file path is a CSV path
+@param: filename as string to validate as .csv
+*/
+bool fileCsv(const std::string& filePath) {
+    // check if the file suffix indicates it is a .csv file
+    if (filePath.substr(filePath.length() - 4, 4) != ".csv") {
+
+        // return false it the file does not end with .csv
+        return false;
+    }
+
+    // return true if the file does exist with a .csv
+    return true;
+}
+
+/*
+Function to evaluate if a string is convertable to an integer
+@param: filename as string to validate as integer
+Method source: https://stackoverflow.com/a/2845275
+*/
+inline bool isInteger(const std::string& checkString)
+{
+
+    // if string contains any characters that are non-numerical, return false
+    if (checkString.empty() || ((!isdigit(checkString[0])) && (checkString[0] != '-') && (checkString[0] != '+'))) return false;
+
+    // create a character, p, to catch any non-digit character in the input
+    char* checkChar;
+
+    // convert string to long, catching any non-integer values
+    strtol(checkString.c_str(), &checkChar, 10);
+
+    // return true if no integer values were found; false if at least one was found.
+    return (*checkChar == 0);
+}
+
+//============================================================================
+// Buffered writer class definition
+//============================================================================
+
+/**
+ * Define a stream buffer that collects output in one large block
+ * The block is only written out when it is full or the stream is flushed,
+ * so printing many lines costs a handful of write calls instead of one per line
+ */
+class BufferedWriter : public streambuf {
+
+private:
+    FILE* file;
+    vector<char> buffer;
+
+    bool writeBuffer();
+
+protected:
+    int overflow(int c) override;
+    streamsize xsputn(const char* text, streamsize count) override;
+    int sync() override;
+
+public:
+    BufferedWriter(FILE* aFile, size_t capacity = 1 << 20);
+    ~BufferedWriter();
+};
+
+/**
+ * Constructor
+ *
+ * @param aFile File the output is written to
+ * @param capacity Size of the block in bytes
+ */
+BufferedWriter::BufferedWriter(FILE* aFile, size_t capacity) {
+    file = aFile;
+    buffer.resize(capacity);
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+/**
+ * Destructor, writes out anything still buffered
+ */
+BufferedWriter::~BufferedWriter() {
+    sync();
+}
+
+/**
+ * Write the buffered block to the file and start a new one
+ */
+bool BufferedWriter::writeBuffer() {
+    size_t count = pptr() - pbase();
+    bool written = fwrite(pbase(), 1, count, file) == count;
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return written;
+}
+
+/**
+ * Called when the block is full
+ */
+int BufferedWriter::overflow(int c) {
+    if (!writeBuffer()) {
+        return traits_type::eof();
+    }
+    if (c != traits_type::eof()) {
+        *pptr() = (char)c;
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+/**
+ * Copy text into the block, writing it out directly when it would not fit
+ */
+streamsize BufferedWriter::xsputn(const char* text, streamsize count) {
+    if (count > epptr() - pptr()) {
+        if (!writeBuffer()) {
+            return 0;
+        }
+
+        // text larger than the whole block skips the copy
+        if (count >= (streamsize)buffer.size()) {
+            return (streamsize)fwrite(text, 1, count, file);
+        }
+    }
+    memcpy(pptr(), text, count);
+    pbump((int)count);
+    return count;
+}
+
+/**
+ * Called when the stream is flushed
+ */
+int BufferedWriter::sync() {
+    if (!writeBuffer() || fflush(file) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+Function to answer one query
+  list             print every course in order
+  schedule         print the prerequisite schedule
+  prereqs <id>     print every prerequisite of a course
+  prefix <text>    print every course whose ID starts with the text
+  search <words>   print every course whose name holds each of the words
+  range <id> <id>  print every course with an ID between the two, both included
+  <id>             print a course
+@param: catalog of courses (loaded, snapshot or paged), query, stream to print to
+*/
+template<typename QueryCatalog>
+void answerQuery(QueryCatalog* catalog, const string& query, ostream& out) {
+    // split the command from its argument
+    size_t space = query.find(' ');
+    string command = query.substr(0, space);
+    string argument = (space == string::npos) ? "" : query.substr(space + 1);
+
+    if (command == "list") {
+        catalog->printSampleSchedule(out);
+    }
+    else if (command == "schedule") {
+        catalog->printPrerequisiteSchedule(out);
+    }
+    else if (command == "prereqs") {
+        catalog->printAllPrerequisites(argument, out);
+    }
+    else if (command == "prefix") {
+        catalog->printCoursesWithPrefix(argument, out);
+    }
+    else if (command == "search") {
+        catalog->printNameSearch(argument, out);
+    }
+    else if (command == "range") {
+        size_t split = argument.find(' ');
+        catalog->printCoursesInRange(argument.substr(0, split), (split == string::npos) ? "" : argument.substr(split + 1), out);
+    }
+    else {
+        catalog->printCourseInformation(query, out);
+    }
+}
+
+/*
+Function to answer one query from the current version of a concurrent
+catalog, which stays pinned while the answer is written
+@param: catalog, query line, stream to write the answer to
+*/
+void answerQuery(ConcurrentCatalog* catalog, const string& query, ostream& out) {
+    ConcurrentCatalog::Reader reader = catalog->Read();
+    answerQuery(&*reader, query, out);
+}
+
+/*
+Function to answer a list of queries, one per line, as described for answerQuery
+Blank lines and lines starting with # are skipped
+@param: catalog of courses (loaded, snapshot or paged), stream of queries, stream to print to
+*/
+template<typename QueryCatalog>
+void runQueries(QueryCatalog* catalog, istream& queries, ostream& out) {
+    string query;
+    while (getline(queries, query)) {
+
+        // drop the carriage return of CRLF files
+        if (!query.empty() && query.back() == '\r') {
+            query.pop_back();
+        }
+        if (query.empty() || query[0] == '#') {
+            continue;
+        }
+        answerQuery(catalog, query, out);
+    }
+}
+
+//============================================================================
+// Query server definitions
+//============================================================================
+
+/*
+The query server answers the queries of runQueries for many local clients
+over a Unix domain socket. The protocol is a line per query, the same lines a
+query file holds. Each answer is framed as its length in bytes on a line of
+its own followed by exactly that many bytes of output, so answers that span
+lines or are empty can be told apart. A client may pipeline: send many
+queries without waiting, and the answers come back in order.
+
+One thread serves every client through epoll. Every query complete in a read
+is answered into the connection's output buffer, and the buffer goes out in as
+few writes as the socket allows. A client that stops reading is not read from
+until its answers drain, so its buffers stay bounded.
+
+A server given a reload function runs it on a thread of its own on SIGHUP,
+and keeps answering meanwhile; a ConcurrentCatalog swaps the new version in
+when it is ready.
+*/
+
+#ifdef __linux__
+
+// set by SIGINT or SIGTERM to stop the server
+volatile sig_atomic_t serverStopping = 0;
+
+// set by SIGHUP to reload the catalog
+volatile sig_atomic_t serverReloadRequested = 0;
+
+/*
+Function to note that the server should stop, called from a signal
+@param: signal number
+*/
+void stopServer(int) {
+    serverStopping = 1;
+}
+
+/*
+Function to note that the catalog should be reloaded, called from a signal
+@param: signal number
+*/
+void requestReload(int) {
+    serverReloadRequested = 1;
+}
+
+/**
+ * Define the state of one client of the query server
+ */
+struct ServerConnection {
+    int fd;
+
+    // bytes read and not yet answered, starting with a partial line
+    string input;
+
+    // answers not yet written, from written on
+    string output;
+    size_t written;
+
+    // true once the client has closed its side, its queries are still answered
+    bool doneSending;
+
+    // events epoll waits for on the socket
+    uint32_t interest;
+};
+
+/*
+Function to open a listening Unix domain socket, replacing a stale socket file
+@param: path of the socket
+@return: the socket, or -1 if it could not be opened
+*/
+int openServerSocket(const string& socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "Socket path is too long: " << socketPath << endl;
+        return -1;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        cerr << "Could not create a socket: " << strerror(errno) << endl;
+        return -1;
+    }
+    unlink(socketPath.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        cerr << "Could not listen on " << socketPath << ": " << strerror(errno) << endl;
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+/*
+Function to write as much pending output as the socket takes
+@param: connection
+@return: false if the connection failed
+*/
+bool flushConnection(ServerConnection& connection) {
+    while (connection.written < connection.output.size()) {
+        ssize_t count = send(connection.fd, connection.output.data() + connection.written,
+            connection.output.size() - connection.written, MSG_NOSIGNAL);
+        if (count < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        connection.written += (size_t)count;
+    }
+
+    // everything went out, reuse the buffer
+    connection.output.clear();
+    connection.written = 0;
+    return true;
+}
+
+/*
+Function to answer every complete query a connection has sent, while its
+output buffer has room
+@param: catalog to answer from, connection, stream reused for each answer
+@return: number of queries answered
+*/
+template<typename QueryCatalog>
+int answerConnection(QueryCatalog* catalog, ServerConnection& connection, ostringstream& answer) {
+    const size_t MAX_PENDING_OUTPUT = 4 << 20;
+    int answered = 0;
+    size_t lineStart = 0;
+    while (connection.output.size() - connection.written < MAX_PENDING_OUTPUT) {
+        size_t lineEnd = connection.input.find('\n', lineStart);
+        if (lineEnd == string::npos) {
+            break;
+        }
+        string query = connection.input.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (!query.empty() && query.back() == '\r') {
+            query.pop_back();
+        }
+
+        // frame the answer with its length, an empty query gets an empty answer
+        answer.str("");
+        if (!query.empty()) {
+            answerQuery(catalog, query, answer);
+        }
+        string text = answer.str();
+        connection.output += to_string(text.size());
+        connection.output += '\n';
+        connection.output += text;
+        answered += 1;
+    }
+    connection.input.erase(0, lineStart);
+    return answered;
+}
+
+/*
+Function to serve queries over a Unix domain socket until SIGINT or SIGTERM
+@param: catalog to answer from, path of the socket,
+        function to reload the catalog on SIGHUP, none to ignore SIGHUP
+@return: exit code
+*/
+template<typename QueryCatalog>
+int serveQueries(QueryCatalog* catalog, const string& socketPath, function<bool()> reload = nullptr) {
+    int listener = openServerSocket(socketPath);
+    if (listener < 0) {
+        return 1;
+    }
+    int events = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    epoll_ctl(events, EPOLL_CTL_ADD, listener, &event);
+
+    // stop cleanly on a signal, and report a closed client through send instead of SIGPIPE
+    serverStopping = 0;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+
+    // one reload runs at a time, beside the queries
+    serverReloadRequested = 0;
+    thread reloader;
+    atomic<bool> reloading(false);
+    if (reload) {
+        signal(SIGHUP, requestReload);
+    }
+    cout << "Serving " << catalog->Size() << " courses on " << socketPath << endl;
+
+    unordered_map<int, ServerConnection> connections;
+    ostringstream answer;
+    char buffer[64 * 1024];
+    epoll_event ready[64];
+    uint64_t served = 0;
+    while (!serverStopping) {
+        int readyCount = epoll_wait(events, ready, 64, 250);
+
+        // a SIGHUP that arrives during a reload waits for it to finish
+        if (serverReloadRequested && reload && !reloading.load()) {
+            serverReloadRequested = 0;
+            if (reloader.joinable()) {
+                reloader.join();
+            }
+            reloading.store(true);
+            reloader = thread([&reload, &reloading]() {
+                reload();
+                reloading.store(false);
+            });
+        }
+
+        for (int i = 0; i < readyCount; i++) {
+            int fd = ready[i].data.fd;
+
+            // accept every waiting client
+            if (fd == listener) {
+                int client;
+                while ((client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    ServerConnection& connection = connections[client];
+                    connection.fd = client;
+                    connection.written = 0;
+                    connection.doneSending = false;
+                    connection.interest = EPOLLIN | EPOLLRDHUP;
+                    event.events = connection.interest;
+                    event.data.fd = client;
+                    epoll_ctl(events, EPOLL_CTL_ADD, client, &event);
+                }
+                continue;
+            }
+            auto found = connections.find(fd);
+            if (found == connections.end()) {
+                continue;
+            }
+            ServerConnection& connection = found->second;
+
+            // read everything the client sent, then answer it in one batch
+            bool open = (ready[i].events & EPOLLERR) == 0;
+            if (!connection.doneSending && (ready[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                while (true) {
+                    ssize_t count = read(fd, buffer, sizeof(buffer));
+                    if (count > 0) {
+                        connection.input.append(buffer, (size_t)count);
+                        continue;
+                    }
+
+                    // the end of the queries, not of the connection, the answers still go out
+                    if (count == 0) {
+                        connection.doneSending = true;
+                        break;
+                    }
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        open = false;
+                    }
+                    break;
+                }
+            }
+            served += answerConnection(catalog, connection, answer);
+            open = flushConnection(connection) && open;
+
+            // queries held back for a full buffer are answered once it drains
+            while (open && connection.written == 0 && connection.output.empty() && connection.input.find('\n') != string::npos) {
+                served += answerConnection(catalog, connection, answer);
+                open = flushConnection(connection);
+            }
+
+            // a client done sending is closed once every complete query it sent is answered and written
+            bool finished = connection.doneSending && connection.output.empty() && connection.input.find('\n') == string::npos;
+            if (!open || finished) {
+                epoll_ctl(events, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                connections.erase(found);
+                continue;
+            }
+
+            // while output is waiting, wait for the socket to take more instead of reading more queries,
+            // and once the client is done sending only output is left, so only wait for that
+            bool waiting = connection.written < connection.output.size();
+            uint32_t interest = (connection.doneSending) ? EPOLLOUT : EPOLLRDHUP | (waiting ? EPOLLOUT : EPOLLIN);
+            if (interest != connection.interest) {
+                event.events = interest;
+                event.data.fd = fd;
+                epoll_ctl(events, EPOLL_CTL_MOD, fd, &event);
+                connection.interest = interest;
+            }
+        }
+    }
+
+    // close every client and remove the socket file
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    close(events);
+    close(listener);
+    unlink(socketPath.c_str());
+    if (reloader.joinable()) {
+        reloader.join();
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGHUP, SIG_DFL);
+    cout << "Server stopped after " << served << " queries" << endl;
+    return 0;
+}
+
+/*
+Function to connect to the query server
+@param: path of the socket
+@return: the connected socket, or -1
+*/
+int connectToServer(const string& socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/*
+Function to send every byte of a request to a blocking socket
+@param: socket, bytes to send
+@return: false if the connection failed
+*/
+bool sendAll(int fd, const string& bytes) {
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t count = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        sent += (size_t)count;
+    }
+    return true;
+}
+
+/*
+Function to read one framed answer from a blocking socket
+Bytes read past the answer are kept for the next one
+@param: socket, bytes read and not yet used, receives the answer
+@return: false if the connection closed first
+*/
+bool readAnswer(int fd, string& pending, string& answer) {
+    char buffer[64 * 1024];
+    size_t lineEnd;
+    while (true) {
+        // a whole frame, its length line and that many bytes, is waiting
+        lineEnd = pending.find('\n');
+        if (lineEnd != string::npos) {
+            size_t length = (size_t)strtoull(pending.c_str(), nullptr, 10);
+            if (pending.size() - lineEnd - 1 >= length) {
+                answer.assign(pending, lineEnd + 1, length);
+                pending.erase(0, lineEnd + 1 + length);
+                return true;
+            }
+        }
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        pending.append(buffer, (size_t)count);
+    }
+}
+
+/*
+Function for the load generator mode: sends queries to a query server from
+several connections at once and reports throughput and latency percentiles
+  ProjectTwo --loadgen server.sock [--connections n] [--requests n] [--pipeline n] [--query-file queries.txt]
+Each connection sends its queries in batches of the pipeline depth and waits
+for the answers of a batch before sending the next. The latency of a query is
+the time from sending its batch to receiving its answer. Without a query file
+the course IDs of the served catalog are looked up
+@param: command line arguments, starting with --loadgen
+@return: exit code
+*/
+int runLoadGeneratorMode(int argc, char* argv[]) {
+    string socketPath = (argc > 2) ? argv[2] : "";
+    string queryPath;
+    int connectionCount = 8;
+    long long requestCount = 100000;
+    int pipeline = 16;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 < argc && option == "--connections" && isInteger(argv[i + 1])) {
+            connectionCount = max(1, stoi(argv[++i]));
+        }
+        else if (i + 1 < argc && option == "--requests" && isInteger(argv[i + 1])) {
+            requestCount = max(1LL, stoll(argv[++i]));
+        }
+        else if (i + 1 < argc && option == "--pipeline" && isInteger(argv[i + 1])) {
+            pipeline = max(1, stoi(argv[++i]));
+        }
+        else if (i + 1 < argc && option == "--query-file") {
+            queryPath = argv[++i];
+        }
+        else {
+            socketPath = "";
+            break;
+        }
+    }
+    if (socketPath.empty() || socketPath[0] == '-') {
+        cerr << "Usage: " << argv[0] << " --loadgen server.sock [--connections n] [--requests n] [--pipeline n] [--query-file queries.txt]" << endl;
+        return 1;
+    }
+
+    // the queries to send, from the file or the IDs of every course served
+    vector<string> queries;
+    if (!queryPath.empty()) {
+        ifstream queryFile(queryPath);
+        if (!queryFile.good()) {
+            cerr << "No such file found: " << queryPath << endl;
+            return 1;
+        }
+        string query;
+        while (getline(queryFile, query)) {
+            if (!query.empty() && query.back() == '\r') {
+                query.pop_back();
+            }
+            if (!query.empty() && query[0] != '#') {
+                queries.push_back(query);
+            }
+        }
+    }
+    else {
+        int fd = connectToServer(socketPath);
+        string pending;
+        string listing;
+        if (fd < 0 || !sendAll(fd, "list\n") || !readAnswer(fd, pending, listing)) {
+            cerr << "Could not reach the server on " << socketPath << endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return 1;
+        }
+        close(fd);
+        stringstream lines(listing);
+        string line;
+        while (getline(lines, line)) {
+            queries.push_back(line.substr(0, line.find(',')));
+        }
+    }
+    if (queries.empty()) {
+        cerr << "No queries to send" << endl;
+        return 1;
+    }
+
+    // each connection runs on its own thread and records the latency of every answer
+    vector<vector<double>> latencies(connectionCount);
+    vector<size_t> answerBytes(connectionCount, 0);
+    atomic<int> failed(0);
+    auto start = chrono::steady_clock::now();
+    runParallel(connectionCount, [&](int connection) {
+        int fd = connectToServer(socketPath);
+        if (fd < 0) {
+            failed += 1;
+            return;
+        }
+        long long quota = requestCount / connectionCount + ((connection < requestCount % connectionCount) ? 1 : 0);
+        latencies[connection].reserve((size_t)quota);
+        size_t next = ((size_t)connection * 7919) % queries.size();
+        string batch;
+        string pending;
+        string answer;
+        for (long long done = 0; done < quota; ) {
+            int batchSize = (int)min((long long)pipeline, quota - done);
+            batch.clear();
+            for (int i = 0; i < batchSize; i++) {
+                batch += queries[next];
+                batch += '\n';
+                next = (next + 1) % queries.size();
+            }
+            auto sent = chrono::steady_clock::now();
+            if (!sendAll(fd, batch)) {
+                failed += 1;
+                break;
+            }
+            for (int i = 0; i < batchSize; i++) {
+                if (!readAnswer(fd, pending, answer)) {
+                    failed += 1;
+                    close(fd);
+                    return;
+                }
+                latencies[connection].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - sent).count());
+                answerBytes[connection] += answer.size();
+            }
+            done += batchSize;
+        }
+        close(fd);
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // merge the latencies and report
+    vector<double> all;
+    size_t bytes = 0;
+    for (int i = 0; i < connectionCount; i++) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        bytes += answerBytes[i];
+    }
+    if (all.empty()) {
+        cerr << "No answers received from " << socketPath << endl;
+        return 1;
+    }
+    sort(all.begin(), all.end());
+    auto percentile = [&all](double fraction) {
+        return all[min(all.size() - 1, (size_t)(fraction * all.size()))];
+    };
+    cout << "Requests: " << all.size() << " over " << connectionCount << " connections, pipeline depth " << pipeline;
+    if (failed.load() > 0) {
+        cout << ", " << failed.load() << " connections failed";
+    }
+    cout << '\n' << fixed << setprecision(1);
+    cout << "Throughput: " << all.size() / seconds << " queries/s, " << bytes / seconds / 1e6 << " MB/s of answers" << '\n';
+    cout << "Latency: p50 " << percentile(0.50) << " us, p99 " << percentile(0.99) << " us, max " << all.back() << " us" << endl;
+    return failed.load() > 0 ? 1 : 0;
+}
+
+#else
+
+/*
+Function standing in for the server where epoll is not available
+*/
+template<typename QueryCatalog>
+int serveQueries(QueryCatalog*, const string&, function<bool()> = nullptr) {
+    cerr << "The query server needs Linux" << endl;
+    return 1;
+}
+
+/*
+Function standing in for the load generator where Unix domain sockets are not available
+*/
+int runLoadGeneratorMode(int, char*[]) {
+    cerr << "The load generator needs Linux" << endl;
+    return 1;
+}
+
+#endif
+
+/*
+Function for printing the --stats report to stderr, after the query results
+@param: catalog of courses, or nullptr when there is none
+*/
+void printStats(Catalog* catalog) {
+    if (catalog != nullptr) {
+        catalog->printStats(cerr);
+    }
+#ifdef COURSE_PLANNER_STATS
+    plannerStats.Print(cerr);
+#else
+    cerr << "Load timing, comparison and lookup counters need a build with -DCOURSE_PLANNER_STATS" << endl;
+#endif
+}
+
+/*
+Function to run without the menu, for scripts:
+  ProjectTwo --load courses.csv [--query-file queries.txt] [--threads n]
+  ProjectTwo [--load courses.csv] --paged courses.db [--cache-mb n] [--query-file queries.txt]
+Queries are read from standard input when no query file is given, and all
+answers go through one large output buffer. With --serve server.sock the
+queries come from clients of a Unix domain socket instead, and a server
+started with --load reloads the CSV file on SIGHUP while it keeps answering.
+With --paged the courses are kept
+in a B+tree file, built from the CSV file when one is given, and only
+--cache-mb megabytes of its pages are held in memory
+@param: command line arguments
+@return: exit code
+*/
+int runBatchMode(int argc, char* argv[]) {
+    string csvPath;
+    string queryPath;
+    string snapshotPath;
+    string savePath;
+    string pagedPath;
+    string servePath;
+    int cacheMb = 16;
+    int threadCount = 0;
+    bool showStats = false;
+
+    // read the options
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 < argc && option == "--load") {
+            csvPath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--query-file") {
+            queryPath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--threads" && isInteger(argv[i + 1])) {
+            threadCount = stoi(argv[++i]);
+        }
+        else if (i + 1 < argc && option == "--snapshot") {
+            snapshotPath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--save-snapshot") {
+            savePath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--paged") {
+            pagedPath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--cache-mb" && isInteger(argv[i + 1])) {
+            cacheMb = stoi(argv[++i]);
+        }
+        else if (i + 1 < argc && option == "--serve") {
+            servePath = argv[++i];
+        }
+        else if (option == "--stats") {
+            showStats = true;
+        }
+        else {
+            cerr << "Unknown option " << option << endl;
+            cerr << "Usage: " << argv[0] << " --load courses.csv [--save-snapshot catalog.bin] [--query-file queries.txt] [--threads n] [--stats]" << endl;
+            cerr << "       " << argv[0] << " --snapshot catalog.bin [--query-file queries.txt] [--stats]" << endl;
+            cerr << "       " << argv[0] << " [--load courses.csv] --paged courses.db [--cache-mb n] [--query-file queries.txt] [--stats]" << endl;
+            cerr << "       " << argv[0] << " --load courses.csv | --snapshot catalog.bin | --paged courses.db --serve server.sock" << endl;
+            return 1;
+        }
+    }
+
+    // open the query stream before loading anything
+    ifstream queryFile;
+    bool useStdin = queryPath.empty() || queryPath == "-";
+    if (!useStdin) {
+        queryFile.open(queryPath);
+        if (!queryFile.good()) {
+            cerr << "No such file found: " << queryPath << endl;
+            return 1;
+        }
+    }
+    istream& queries = useStdin ? static_cast<istream&>(cin) : queryFile;
+
+    // answer every query through one buffered writer
+    BufferedWriter writer(stdout);
+    ostream out(&writer);
+
+    // a snapshot is queried where it lies, without parsing the CSV file
+    if (!snapshotPath.empty()) {
+        CatalogSnapshot snapshot;
+        if (!snapshot.Open(snapshotPath)) {
+            cerr << "Not a course snapshot: " << snapshotPath << endl;
+            return 1;
+        }
+        if (!servePath.empty()) {
+            return serveQueries(&snapshot, servePath);
+        }
+        runQueries(&snapshot, queries, out);
+        out.flush();
+        if (showStats) {
+            printStats(nullptr);
+        }
+        return 0;
+    }
+
+    // a paged tree is built from the CSV file or opened, and queried through its page cache
+    if (!pagedPath.empty()) {
+        PagedCourseTree tree;
+        size_t cacheBytes = (size_t)max(cacheMb, 0) << 20;
+        if (!csvPath.empty()) {
+            if (!tree.Create(pagedPath, cacheBytes) || !loadPagedCourses(csvPath, &tree)) {
+                return 1;
+            }
+        }
+        else if (!tree.Open(pagedPath, cacheBytes)) {
+            cerr << "Not a paged course tree: " << pagedPath << endl;
+            return 1;
+        }
+        cout << flush;
+        if (!servePath.empty()) {
+            return serveQueries(&tree, servePath);
+        }
+        runQueries(&tree, queries, out);
+        out.flush();
+        if (showStats) {
+            tree.printStats(cerr);
+            printStats(nullptr);
+        }
+        return 0;
+    }
+
+    // otherwise a catalog is required
+    if (csvPath.empty() || !fileExists(csvPath)) {
+        cerr << "No such file found: " << csvPath << endl;
+        return 1;
+    }
+
+    // a served catalog can be reloaded while readers keep answering from the version they pinned
+    if (!servePath.empty()) {
+        ConcurrentCatalog served;
+        cout << "Loading CSV file " << csvPath << "..." << endl;
+        if (!served.Reload(csvPath, threadCount)) {
+            return 1;
+        }
+        cout << served.Size() << " courses loaded from file." << endl;
+        if (!savePath.empty()) {
+            if (!CatalogSnapshot::Save(served.Read()->PrerequisiteGraph(), savePath)) {
+                return 1;
+            }
+            cout << "Saved " << served.Size() << " courses to " << savePath << endl;
+        }
+        return serveQueries(&served, servePath, [&served, csvPath, threadCount]() {
+            cout << "Reloading CSV file " << csvPath << "..." << endl;
+            if (!served.Reload(csvPath, threadCount)) {
+                return false;
+            }
+            cout << served.Size() << " courses loaded from file." << endl;
+            return true;
+        });
+    }
+
+    // load and freeze the tree for lookups
+    Catalog catalog;
+    loadCourses(csvPath, &catalog, threadCount);
+    catalog.Freeze();
+    if (!savePath.empty()) {
+        if (!CatalogSnapshot::Save(catalog.PrerequisiteGraph(), savePath)) {
+            return 1;
+        }
+        cout << "Saved " << catalog.Size() << " courses to " << savePath << endl;
+    }
+    cout << flush;
+
+    runQueries(&catalog, queries, out);
+    out.flush();
+    if (showStats) {
+        printStats(&catalog);
+    }
+    return 0;
+}
+
 
-    // sort the course ID vector for faster searchability later on
-    quickSort(courseIdVector, 0, courseIdVector.size() - 1);
-
-    // close file of course information
-    inputFile.close();
+//============================================================================
+// Benchmark definitions
+//============================================================================
 
+// results are added here so the compiler cannot drop the timed work
+volatile size_t benchmarkSink = 0;
+
+// one measured backend on one catalog
+struct BenchmarkResult {
+    string shape;
+    int courseCount;
+    string backend;
+    double loadMs;
+    double lookupNs;
+    double listMs;
+    size_t memoryBytes;
+};
 
-    /*
-    * Start iterating through the file again, this time collecting course ID, name, and prerequisites.
-    * The vector of course IDs will be used to validate course prerequisites (are they in the list of classes)
-    */
-    // open file of course information
-    inputFile.open(csvPath);
-    
-    // iterate over file to collect each item
-    while (!inputFile.eof()) {
+/*
+Function to measure the milliseconds since a start time
+@param: start time
+*/
+inline double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
 
-        // reset the column count to 0
-        columnCount = 0;
+/*
+Function to generate a synthetic catalog, with prerequisites only on courses
+generated earlier so the catalog never has a cycle
+  random    course IDs in random order, up to two prerequisites each
+  sorted    course IDs in ascending order
+  reverse   course IDs in descending order
+  prereqs   random order, two to eight prerequisites each
+  skewed    random order, four in five courses in one department
+@param: shape of the catalog, number of courses, random seed, list to fill
+*/
+bool generateCatalog(const string& shape, int count, uint32_t seed, vector<Course>& courseList) {
+    if (shape != "random" && shape != "sorted" && shape != "reverse" && shape != "prereqs" && shape != "skewed") {
+        return false;
+    }
+    mt19937 random(seed);
+    const int DEPARTMENTS = 64;
+
+    // a department code and a number unique to the course, such as CSCI100042
+    courseList.assign(count, Course());
+    for (int i = 0; i < count; i++) {
+        int department = (int)(random() % DEPARTMENTS);
+        if (shape == "skewed") {
+            department = (random() % 5 != 0) ? 0 : 1 + (int)(random() % (DEPARTMENTS - 1));
+        }
+        string courseId(4, 'A');
+        courseId[0] = (char)('C' + department % 4);
+        courseId[1] = (char)('A' + department / 4);
+        courseId[2] = 'S';
+        courseId[3] = 'C';
+        courseList[i].courseId = courseId + to_string(100000 + i);
+        courseList[i].name = "Synthetic Course " + to_string(i);
+
+        // prerequisites are drawn from the courses before this one
+        int prereqCount = (shape == "prereqs") ? 2 + (int)(random() % 7) : (int)(random() % 3);
+        for (int j = 0; j < prereqCount && i > 0; j++) {
+            courseList[i].prereq.push_back(courseList[random() % i].courseId);
+        }
+    }
 
-        // create a temporary course object to add to binary search tree
-        struct Course tempCourse;
+    // put the courses in the order the shape is loaded in
+    auto byId = [](const Course& a, const Course& b) {
+        return a.courseId < b.courseId;
+    };
+    if (shape == "sorted") {
+        sort(courseList.begin(), courseList.end(), byId);
+    }
+    else if (shape == "reverse") {
+        sort(courseList.rbegin(), courseList.rend(), byId);
+    }
+    else {
+        shuffle(courseList.begin(), courseList.end(), random);
+    }
+    return true;
+}
 
-        // get each line in CSV file, separated by newline character
-        getline(inputFile, courseLine, '\n');
+/*
+Function to pick course IDs to look up, nine in ten hit a course and the rest miss
+@param: courses of the catalog, number of lookups, random seed
+*/
+vector<string> generateLookups(const vector<Course>& courseList, int count, uint32_t seed) {
+    mt19937 random(seed + 1);
+    vector<string> lookups(count);
+    for (int i = 0; i < count; i++) {
+        if (random() % 10 != 0) {
+            lookups[i] = courseList[random() % courseList.size()].courseId;
+        }
+        else {
+            lookups[i] = "ZZZZ" + to_string(random() % 1000000);
+        }
+    }
+    return lookups;
+}
 
-        // skip final iteration if end of file reached
-        if (inputFile.eof()) break;
+/*
+Function to measure one catalog storage on one catalog
+@param: storage to fill, true to sort and bulk load instead of inserting in file order,
+        courses in load order, course IDs to look up, result to fill
+*/
+template<typename Storage>
+void measureStorage(Storage& storage, bool bulk, const vector<Course>& courseList, const vector<string>& lookups, BenchmarkResult& result) {
+    size_t sink = 0;
+
+    auto start = chrono::steady_clock::now();
+    if (bulk) {
+        vector<Course> sorted(courseList);
+        stable_sort(sorted.begin(), sorted.end(), [](const Course& a, const Course& b) {
+            return a.courseId < b.courseId;
+        });
+        storage.BuildFromSorted(sorted);
+        storage.Freeze();
+    }
+    else {
+        for (int i = 0; i < (int)courseList.size(); i++) {
+            storage.Insert(courseList[i]);
+        }
+    }
+    result.loadMs = elapsedMs(start);
 
-        // start a string stream with basis of courseLine for separating a line by comma characteers
-        stringstream ss(courseLine);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < (int)lookups.size(); i++) {
+        const Course* course = storage.Find(lookups[i]);
+        sink += (course != nullptr) ? course->name.size() : 1;
+    }
+    result.lookupNs = elapsedMs(start) * 1e6 / max((size_t)1, lookups.size());
 
+    // a storage without an order sorts here, on the first listing after a change
+    start = chrono::steady_clock::now();
+    for (auto it = storage.begin(); it != storage.end(); ++it) {
+        sink += it->name.size();
+    }
+    result.listMs = elapsedMs(start);
+    result.memoryBytes = storage.MemoryUsage();
+    benchmarkSink = benchmarkSink + sink;
+}
 
-        // while there are more objects in the course Line
-        while (ss.good()) {
+/*
+Function to measure one backend on one catalog
+  bst       BinarySearchTree, one Insert per course in file order
+  bst-bulk  BinarySearchTree, sorted and built in one pass then frozen, as the loader does
+  hash      FlatHashStorage, one Insert per course in file order
+  vector    SortedVectorStorage, sorted and taken in one pass
+@param: backend name, courses in load order, course IDs to look up, result to fill
+*/
+bool measureBackend(const string& backend, const vector<Course>& courseList, const vector<string>& lookups, BenchmarkResult& result) {
+    result.backend = backend;
+    if (backend == "bst" || backend == "bst-bulk") {
+        BinarySearchTree tree;
+        measureStorage(tree, backend == "bst-bulk", courseList, lookups, result);
+    }
+    else if (backend == "hash") {
+        FlatHashStorage table;
+        measureStorage(table, false, courseList, lookups, result);
+    }
+    else if (backend == "vector") {
+        SortedVectorStorage sorted;
+        measureStorage(sorted, true, courseList, lookups, result);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
 
-            // if the current position is the first column....
-            if (columnCount == 0) {
+/*
+Function to write a catalog as CSV text, with every third name quoted around
+a comma and every other line ending in CRLF, as exports from other systems do
+@param: courses to write
+*/
+string generateCsvText(const vector<Course>& courseList) {
+    string text;
+    for (int i = 0; i < (int)courseList.size(); i++) {
+        text += courseList[i].courseId;
+        text += (i % 3 == 0) ? ",\"" + courseList[i].name + ", Part 1\"" : "," + courseList[i].name;
+        for (int j = 0; j < (int)courseList[i].prereq.size(); j++) {
+            text += "," + courseList[i].prereq[j];
+        }
+        text += (i % 2 == 0) ? "\n" : "\r\n";
+    }
+    return text;
+}
 
-                // add the first item (up to the first comma) to tempCourse's courseId
-                getline(ss, tempCourseId, ',');
+/*
+Function to split CSV text the way the loader first did, a getline for each
+line and a getline on commas for each field, without understanding quotes
+@param: CSV text
+@return: number of fields
+*/
+size_t countFieldsIostream(const string& text) {
+    size_t fieldCount = 0;
+    istringstream lines(text);
+    string line;
+    while (getline(lines, line)) {
+        stringstream fields(line);
+        string field;
+        while (getline(fields, field, ',')) {
+            fieldCount += 1;
+        }
+    }
+    return fieldCount;
+}
 
-                // transform the course ID to all uppercase characters for consistency and comparison logic
-                transform(tempCourseId.begin(), tempCourseId.end(), tempCourseId.begin(), ::toupper);
+/*
+Function to split CSV text with the tokenizer and the current mask function
+@param: CSV text
+@return: number of fields
+*/
+size_t countFieldsTokenizer(const string& text) {
+    size_t fieldCount = 0;
+    CsvTokenizer tokenizer(text.data(), text.data() + text.size());
+    vector<CsvField> fields;
+    while (tokenizer.NextRecord(fields)) {
+        fieldCount += fields.size();
+    }
+    return fieldCount;
+}
 
-                // add the course Id to the temporary course object
-                tempCourse.courseId = tempCourseId;
+/*
+Function to measure how fast each way of splitting CSV text runs, best of three
+runs: the iostream path the loader used to take and the tokenizer with each
+mask function this CPU can run
+@param: catalog sizes, random seed, output format, true before the first JSON object
+*/
+void measureCsvParsers(const vector<int>& sizes, uint32_t seed, const string& format, bool& first) {
+    vector<pair<string, CsvMaskFunction>> masks = availableCsvMasks();
+    CsvMaskFunction bestMask = csvSpecialMask;
+    for (int n = 0; n < (int)sizes.size(); n++) {
+        vector<Course> courseList;
+        generateCatalog("random", sizes[n], seed, courseList);
+        string text = generateCsvText(courseList);
+
+        for (int p = 0; p <= (int)masks.size(); p++) {
+            string parser = (p == 0) ? "iostream" : masks[p - 1].first;
+            double bestMs = 0;
+            for (int run = 0; run < 3; run++) {
+                auto start = chrono::steady_clock::now();
+                if (p == 0) {
+                    benchmarkSink = benchmarkSink + countFieldsIostream(text);
+                }
+                else {
+                    csvSpecialMask = masks[p - 1].second;
+                    benchmarkSink = benchmarkSink + countFieldsTokenizer(text);
+                }
+                double ms = elapsedMs(start);
+                bestMs = (run == 0) ? ms : min(bestMs, ms);
             }
-            // if the current position is the second column....
-            else if (columnCount == 1) {
+            double gbPerSecond = text.size() / (bestMs * 1e6);
 
-                // add the second item (up to the second comma) to tempCourse's name
-                getline(ss, tempCourse.name, ',');
+            if (format == "csv") {
+                cout << parser << ',' << sizes[n] << ',' << text.size() << ',' << fixed << setprecision(3) << bestMs << ',' << gbPerSecond << endl;
             }
-
-            // if the current position is in a column greater than the second....
             else {
+                cout << (first ? "\n" : ",\n") << "  {\"parser\": \"" << parser << "\", \"courses\": " << sizes[n] << ", \"bytes\": " << text.size()
+                     << ", " << fixed << setprecision(3) << "\"ms\": " << bestMs << ", \"gb_per_s\": " << gbPerSecond << "}" << flush;
+            }
+            first = false;
+        }
+    }
+    csvSpecialMask = bestMask;
+}
 
-                // add the current item to the local variable tempPrequisite
-                getline(ss, tempPrereq, ',');
-
-                // if the prerequisite variable is not empty
-                if (!tempPrereq.empty()) {
-
-                    // search for the prerequisite course in the course list
-                    courseIndex = binarySearch(courseIdVector, courseIdVector.size(), tempPrereq);
-                    
-                    // only add the prerequisite if it exists in the course list
-                    if (courseIndex != -1) {
-                        // add the prerequisite to the prereq vector
-                        tempCourse.prereq.push_back(tempPrereq);
-                    }
-                    else {
-                        // output error message for a prerequisite not found in the list of courses
-                        cout << tempPrereq << " was not added as a prerequisite for " << tempCourseId << " because it is not found in the course list. " << endl;
-                    }
+/*
+Function to measure point lookups on one bulk loaded tree, first walking its
+node pointers and then through the Eytzinger index Freeze builds, best of
+three runs each
+@param: catalog sizes, number of lookups, random seed, output format, true before the first JSON object
+*/
+void measureFrozenLookups(const vector<int>& sizes, int lookupCount, uint32_t seed, const string& format, bool& first) {
+    for (int n = 0; n < (int)sizes.size(); n++) {
+        vector<Course> courseList;
+        generateCatalog("sorted", sizes[n], seed, courseList);
+        vector<string> lookups = generateLookups(courseList, lookupCount, seed);
+        BinarySearchTree tree;
+        tree.BuildFromSorted(courseList);
+
+        // the same lookups before and after the tree is frozen
+        double layoutNs[2];
+        for (int frozen = 0; frozen < 2; frozen++) {
+            if (frozen == 1) {
+                tree.Freeze();
+            }
+            for (int run = 0; run < 3; run++) {
+                size_t sink = 0;
+                auto start = chrono::steady_clock::now();
+                for (int i = 0; i < (int)lookups.size(); i++) {
+                    const Course* course = tree.Find(lookups[i]);
+                    sink += (course != nullptr) ? course->name.size() : 1;
                 }
+                double ns = elapsedMs(start) * 1e6 / lookups.size();
+                layoutNs[frozen] = (run == 0) ? ns : min(layoutNs[frozen], ns);
+                benchmarkSink = benchmarkSink + sink;
             }
-
-            // increase the column count by one
-            columnCount += 1;
         }
 
-        // send an error message if there is not a course name included in the name.
-        if (tempCourse.name.empty()) {
-
-            cout << tempCourse.courseId << " does not have a name, and was not added to the course list." <<endl;
+        if (format == "csv") {
+            cout << sizes[n] << ',' << fixed << setprecision(3) << layoutNs[0] << ',' << layoutNs[1] << ',' << layoutNs[0] / layoutNs[1] << endl;
         }
         else {
-            //Insert course into binary search tree
-            bst->Insert(tempCourse);
-            courseCount += 1;
+            cout << (first ? "\n" : ",\n") << "  {\"courses\": " << sizes[n] << ", " << fixed << setprecision(3)
+                 << "\"pointer_ns\": " << layoutNs[0] << ", \"eytzinger_ns\": " << layoutNs[1] << ", \"speedup\": " << layoutNs[0] / layoutNs[1] << "}" << flush;
         }
-
+        first = false;
     }
-    // output the number of courses loaded from file
-    cout << courseCount << " courses loaded from file." << endl;
-
 }
+
 /*
-In-Order algorithm
-@param: starting node
+Function to measure how load time scales with parse threads, best of three
+runs of readCourses on a generated CSV file for each thread count. One
+thread is always measured first, as the baseline of the speedup. Files
+under 1 MB per thread are parsed on fewer threads, as the loader does
+@param: catalog sizes, thread counts, random seed, output format, true before the first JSON object
+@return: false if the CSV file could not be written
 */
-void BinarySearchTree::inOrder(Node* node) {
-    //if node is not equal to null ptr
-    if (node == nullptr) {
-        return;
+bool measureParseThreads(const vector<int>& sizes, vector<int> threadCounts, uint32_t seed, const string& format, bool& first) {
+    if (threadCounts.empty() || threadCounts[0] != 1) {
+        threadCounts.insert(threadCounts.begin(), 1);
     }
-    //InOrder not left
-    inOrder(node->left);
-    //output bidID, title, amount, fund
-    std::cout << node->course.courseId << ", " << node->course.name;
-    // end line
-    cout << endl;
-
-    //InOrder right
-    inOrder(node->right);
-}
+    string csvPath = (filesystem::temp_directory_path() / ("course-planner-benchmark-" + to_string(seed) + ".csv")).string();
+    for (int n = 0; n < (int)sizes.size(); n++) {
+        vector<Course> courseList;
+        generateCatalog("prereqs", sizes[n], seed, courseList);
+        string text = generateCsvText(courseList);
+        ofstream csvFile(csvPath, ios::binary);
+        csvFile.write(text.data(), text.size());
+        csvFile.close();
+        if (!csvFile) {
+            cerr << "Could not write " << csvPath << endl;
+            return false;
+        }
 
-// function for printing classes in alphanumerical order
-void BinarySearchTree::printSampleSchedule() {
-    inOrder(root);
+        double oneThreadMs = 0;
+        for (int t = 0; t < (int)threadCounts.size(); t++) {
+            double bestMs = 0;
+            for (int run = 0; run < 3; run++) {
+                vector<Course> loaded;
+                auto start = chrono::steady_clock::now();
+                readCourses(csvPath, loaded, threadCounts[t]);
+                double ms = elapsedMs(start);
+                bestMs = (run == 0) ? ms : min(bestMs, ms);
+                benchmarkSink = benchmarkSink + loaded.size();
+            }
+            if (t == 0) {
+                oneThreadMs = bestMs;
+            }
+            double speedup = oneThreadMs / bestMs;
+            if (format == "csv") {
+                cout << sizes[n] << ',' << text.size() << ',' << threadCounts[t] << ',' << fixed << setprecision(3) << bestMs << ',' << speedup << endl;
+            }
+            else {
+                cout << (first ? "\n" : ",\n") << "  {\"courses\": " << sizes[n] << ", \"bytes\": " << text.size() << ", \"threads\": " << threadCounts[t]
+                     << ", " << fixed << setprecision(3) << "\"ms\": " << bestMs << ", \"speedup\": " << speedup << "}" << flush;
+            }
+            first = false;
+        }
+    }
+    filesystem::remove(csvPath);
+    return true;
 }
 
-
 /*
-Function for printing a specific course based on input course ID
-@param: courseId for search
-
+Function to measure the course ID sorts on sorted, reverse sorted, all
+duplicate and random IDs, best of three runs: the MSD radix sort the loader
+uses for short IDs, the introsort it falls back to, and std::sort
+@param: catalog sizes, random seed, output format, true before the first JSON object
+@return: false if a sort gave a different order than std::sort
 */
-void BinarySearchTree::printCourseInformation(string courseId) {
-
-    // transform input to uppercase for compariosn
-    transform(courseId.begin(), courseId.end(), courseId.begin(), ::toupper);
-
-    // set current node equal to root
-    Node* curNode = root;
+bool measureSorts(const vector<int>& sizes, uint32_t seed, const string& format, bool& first) {
+    vector<string> inputs = { "sorted", "reverse", "duplicate", "random" };
+    vector<string> algorithms = { "radix", "introsort", "std::sort" };
+    for (int n = 0; n < (int)sizes.size(); n++) {
+        vector<Course> courseList;
+        generateCatalog("random", sizes[n], seed, courseList);
+        vector<string> randomIds(courseList.size());
+        for (int i = 0; i < (int)courseList.size(); i++) {
+            randomIds[i] = courseList[i].courseId;
+        }
+        vector<string> sortedIds(randomIds);
+        sort(sortedIds.begin(), sortedIds.end());
 
-    // keep looping downwards until bottom reached or matching bidId found
-    // 
-    while (curNode != nullptr) {
+        for (int in = 0; in < (int)inputs.size(); in++) {
+            vector<string> input;
+            if (inputs[in] == "sorted") {
+                input = sortedIds;
+            }
+            else if (inputs[in] == "reverse") {
+                input.assign(sortedIds.rbegin(), sortedIds.rend());
+            }
+            else if (inputs[in] == "duplicate") {
+                input.assign(sortedIds.size(), "CSCI100");
+            }
+            else {
+                input = randomIds;
+            }
+            vector<string> expected(input);
+            sort(expected.begin(), expected.end());
+
+            for (int a = 0; a < (int)algorithms.size(); a++) {
+                double bestMs = 0;
+                for (int run = 0; run < 3; run++) {
+                    vector<string> courseIds(input);
+                    vector<string> buffer(courseIds.size());
+                    auto start = chrono::steady_clock::now();
+                    if (algorithms[a] == "radix") {
+                        radixSort(courseIds, buffer, 0, (int)courseIds.size(), 0);
+                    }
+                    else if (algorithms[a] == "introsort") {
+                        introSort(courseIds, 0, (int)courseIds.size() - 1, introSortDepthLimit((int)courseIds.size()));
+                    }
+                    else {
+                        sort(courseIds.begin(), courseIds.end());
+                    }
+                    double ms = elapsedMs(start);
+                    bestMs = (run == 0) ? ms : min(bestMs, ms);
 
-        // if match found, return current bid
-        if (curNode->course.courseId.compare(courseId) == 0) {
-            //output course Id, course name
-            std::cout << curNode->course.courseId << ", " << curNode->course.name << endl;
+                    if (courseIds != expected) {
+                        cerr << algorithms[a] << " did not sort the " << inputs[in] << " input of " << sizes[n] << " IDs" << endl;
+                        return false;
+                    }
+                }
 
-            //iterate over prerequisite list, printing off each prerequisite
-            for (int i = 0; i < curNode->course.prereq.size(); i++) {
+                if (format == "csv") {
+                    cout << inputs[in] << ',' << sizes[n] << ',' << algorithms[a] << ',' << fixed << setprecision(3) << bestMs << endl;
+                }
+                else {
+                    cout << (first ? "\n" : ",\n") << "  {\"input\": \"" << inputs[in] << "\", \"courses\": " << sizes[n]
+                         << ", \"algorithm\": \"" << algorithms[a] << "\", " << fixed << setprecision(3) << "\"ms\": " << bestMs << "}" << flush;
+                }
+                first = false;
+            }
+        }
+    }
+    return true;
+}
 
-                // output prerequisites label
-                if (i == 0){
-                    cout << "Prerequisites: ";
+/*
+Function to measure query throughput of the batch mode against the menu,
+answering the same queries to the null device, best of three runs. The menu
+writes through cout kept in step with stdio, which passes every piece of
+output on to stdio at once and writes each line out as it ends. The batch
+mode collects everything in one 1 MB BufferedWriter
+  lookups   the given number of course lookups, one in ten missing
+  lists     ten full course listings
+@param: catalog sizes, number of lookups, random seed, output format, true before the first JSON object
+@return: false if the null device could not be opened
+*/
+bool measureBatchOutput(const vector<int>& sizes, int lookupCount, uint32_t seed, const string& format, bool& first) {
+#ifdef _WIN32
+    const char* nullDevice = "NUL";
+#else
+    const char* nullDevice = "/dev/null";
+#endif
+    vector<string> workloads = { "lookups", "lists" };
+    vector<string> paths = { "interactive", "batch" };
+    for (int n = 0; n < (int)sizes.size(); n++) {
+        vector<Course> courseList;
+        generateCatalog("random", sizes[n], seed, courseList);
+        vector<string> lookups = generateLookups(courseList, lookupCount, seed);
+        stable_sort(courseList.begin(), courseList.end(), [](const Course& a, const Course& b) {
+            return a.courseId < b.courseId;
+        });
+        Catalog catalog;
+        catalog.BuildFromSorted(courseList);
+        catalog.Freeze();
+
+        for (int w = 0; w < (int)workloads.size(); w++) {
+            vector<string> queries = (workloads[w] == "lookups") ? lookups : vector<string>(10, "list");
+
+            // the bytes written are counted once, outside the timed runs
+            ostringstream answers;
+            for (int i = 0; i < (int)queries.size(); i++) {
+                answerQuery(&catalog, queries[i], answers);
+            }
+            size_t byteCount = answers.str().size();
+
+            for (int p = 0; p < (int)paths.size(); p++) {
+                double bestMs = 0;
+                for (int run = 0; run < 3; run++) {
+                    FILE* file = fopen(nullDevice, "w");
+                    if (file == nullptr) {
+                        cerr << "Could not open " << nullDevice << endl;
+                        return false;
+                    }
+                    bool interactive = paths[p] == "interactive";
+                    if (interactive) {
+                        setvbuf(file, nullptr, _IOLBF, BUFSIZ);
+                    }
+                    auto start = chrono::steady_clock::now();
+                    {
+                        BufferedWriter writer(file, interactive ? 1 : 1 << 20);
+                        ostream out(&writer);
+                        for (int i = 0; i < (int)queries.size(); i++) {
+                            answerQuery(&catalog, queries[i], out);
+                        }
+                        out.flush();
+                    }
+                    fclose(file);
+                    double ms = elapsedMs(start);
+                    bestMs = (run == 0) ? ms : min(bestMs, ms);
                 }
+                double queriesPerSecond = queries.size() / (bestMs / 1000);
+                double mbPerSecond = byteCount / (bestMs * 1000);
 
-                // output comma to separate prerequisites
+                if (format == "csv") {
+                    cout << workloads[w] << ',' << sizes[n] << ',' << paths[p] << ',' << queries.size() << ',' << fixed << setprecision(3)
+                         << bestMs << ',' << queriesPerSecond << ',' << mbPerSecond << endl;
+                }
                 else {
-                    cout << ", ";
+                    cout << (first ? "\n" : ",\n") << "  {\"workload\": \"" << workloads[w] << "\", \"courses\": " << sizes[n]
+                         << ", \"path\": \"" << paths[p] << "\", \"queries\": " << queries.size() << ", " << fixed << setprecision(3)
+                         << "\"ms\": " << bestMs << ", \"queries_per_s\": " << queriesPerSecond << ", \"mb_per_s\": " << mbPerSecond << "}" << flush;
                 }
-
-                // ouput prerequisite
-                cout << curNode->course.prereq[i];
+                first = false;
             }
+        }
+    }
+    return true;
+}
 
-            // add an end line
-            cout << endl;
-            return;
+/*
+Function to split a comma separated option into its values
+@param: option text
+*/
+vector<string> splitOption(const string& text) {
+    vector<string> values;
+    stringstream stream(text);
+    string value;
+    while (getline(stream, value, ',')) {
+        if (!value.empty()) {
+            values.push_back(value);
         }
+    }
+    return values;
+}
 
-        // if bid is smaller than current node then traverse left
-        if (curNode->course.courseId.compare(courseId) > 0) {
-            curNode = curNode->left;
+/*
+Function for the benchmark mode: measures load, point lookup, full listing and
+memory of each backend on synthetic catalogs of each shape and size, printing
+one CSV row or JSON object per measurement. One of these measures something else instead:
+  --csv     the CSV tokenizer, in GB/s for each mask function against the iostream path
+  --frozen  tree lookups through node pointers against the frozen Eytzinger index,
+            at 10k, 1M and 10M courses unless --sizes is given
+  --parse-threads 1,2,4,...
+            load time of a CSV file on each number of parse threads and the
+            speedup over one thread, at 1M courses unless --sizes is given
+  --sort    the radix sort and introsort of course IDs against std::sort
+  --batch   query throughput of the batch mode against the menu's output path,
+            at 100k courses unless --sizes is given
+@param: command line arguments, starting with --benchmark
+*/
+int runBenchmarkMode(int argc, char* argv[]) {
+    vector<string> shapes = { "random", "sorted", "reverse", "prereqs", "skewed" };
+    vector<string> backends = { "bst", "bst-bulk", "hash", "vector" };
+    vector<int> sizes = { 1000, 10000, 100000, 1000000 };
+    vector<int> threadCounts;
+    int lookupCount = 1000000;
+    uint32_t seed = 1;
+    string format = "csv";
+    string measurement = "backends";
+    bool sizesGiven = false;
+
+    // read the options
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        if (i + 1 < argc && option == "--shapes") {
+            shapes = splitOption(argv[++i]);
+        }
+        else if (i + 1 < argc && option == "--backends") {
+            backends = splitOption(argv[++i]);
+        }
+        else if (i + 1 < argc && option == "--sizes") {
+            sizes.clear();
+            sizesGiven = true;
+            vector<string> values = splitOption(argv[++i]);
+            for (int j = 0; j < (int)values.size(); j++) {
+                if (!isInteger(values[j]) || stol(values[j]) <= 0 || stol(values[j]) > 50000000) {
+                    cerr << "Bad size " << values[j] << endl;
+                    return 1;
+                }
+                sizes.push_back(stoi(values[j]));
+            }
+        }
+        else if (i + 1 < argc && option == "--lookups" && isInteger(argv[i + 1])) {
+            lookupCount = max(1, stoi(argv[++i]));
+        }
+        else if (i + 1 < argc && option == "--seed" && isInteger(argv[i + 1])) {
+            seed = (uint32_t)stoul(argv[++i]);
+        }
+        else if (i + 1 < argc && option == "--format" && (string(argv[i + 1]) == "csv" || string(argv[i + 1]) == "json")) {
+            format = argv[++i];
+        }
+        else if (option == "--csv" || option == "--frozen" || option == "--sort" || option == "--batch") {
+            measurement = option.substr(2);
+        }
+        else if (i + 1 < argc && option == "--parse-threads") {
+            measurement = "parse-threads";
+            vector<string> values = splitOption(argv[++i]);
+            for (int j = 0; j < (int)values.size(); j++) {
+                if (!isInteger(values[j]) || stol(values[j]) <= 0 || stol(values[j]) > 1024) {
+                    cerr << "Bad thread count " << values[j] << endl;
+                    return 1;
+                }
+                threadCounts.push_back(stoi(values[j]));
+            }
         }
-        // else larger so traverse right
         else {
-            curNode = curNode->right;
+            cerr << "Unknown option " << option << endl;
+            cerr << "Usage: " << argv[0] << " --benchmark [--shapes random,sorted,reverse,prereqs,skewed]"
+                 << " [--backends bst,bst-bulk,hash,vector] [--sizes 1000,10000,...] [--lookups n] [--seed n] [--format csv|json]" << endl;
+            cerr << "       " << argv[0] << " --benchmark --csv [--sizes 1000,10000,...] [--seed n] [--format csv|json]" << endl;
+            cerr << "       " << argv[0] << " --benchmark --frozen [--sizes 10000,1000000,...] [--lookups n] [--seed n] [--format csv|json]" << endl;
+            cerr << "       " << argv[0] << " --benchmark --parse-threads 1,2,4,8,16 [--sizes 1000000,...] [--seed n] [--format csv|json]" << endl;
+            cerr << "       " << argv[0] << " --benchmark --sort [--sizes 1000,10000,...] [--seed n] [--format csv|json]" << endl;
+            cerr << "       " << argv[0] << " --benchmark --batch [--sizes 100000,...] [--lookups n] [--seed n] [--format csv|json]" << endl;
+            return 1;
         }
     }
 
-    // return statement for any input that does not have a matching course Id
-    cout << "No course found with Id " << courseId << endl;
+    // every measurement but the backends is made on its own
+    if (measurement != "backends") {
+        bool first = true;
+        if (format == "json") {
+            cout << "[";
+        }
+        if (measurement == "csv") {
+            if (format == "csv") {
+                cout << "parser,courses,bytes,ms,gb_per_s" << endl;
+            }
+            measureCsvParsers(sizes, seed, format, first);
+        }
+        else if (measurement == "frozen") {
+            if (!sizesGiven) {
+                sizes = { 10000, 1000000, 10000000 };
+            }
+            if (format == "csv") {
+                cout << "courses,pointer_ns,eytzinger_ns,speedup" << endl;
+            }
+            measureFrozenLookups(sizes, lookupCount, seed, format, first);
+        }
+        else if (measurement == "parse-threads") {
+            if (!sizesGiven) {
+                sizes = { 1000000 };
+            }
+            if (format == "csv") {
+                cout << "courses,bytes,threads,ms,speedup" << endl;
+            }
+            if (!measureParseThreads(sizes, threadCounts, seed, format, first)) {
+                return 1;
+            }
+        }
+        else if (measurement == "sort") {
+            if (format == "csv") {
+                cout << "input,courses,algorithm,ms" << endl;
+            }
+            if (!measureSorts(sizes, seed, format, first)) {
+                return 1;
+            }
+        }
+        else if (measurement == "batch") {
+            if (!sizesGiven) {
+                sizes = { 100000 };
+            }
+            if (format == "csv") {
+                cout << "workload,courses,path,queries,ms,queries_per_s,mb_per_s" << endl;
+            }
+            if (!measureBatchOutput(sizes, lookupCount, seed, format, first)) {
+                return 1;
+            }
+        }
+        if (format == "json") {
+            cout << "\n]" << endl;
+        }
+        return 0;
+    }
+
+    if (format == "csv") {
+        cout << "shape,courses,backend,load_ms,lookup_ns,list_ms,memory_bytes" << endl;
+    }
+    else {
+        cout << "[";
+    }
+    bool first = true;
+    for (int s = 0; s < (int)shapes.size(); s++) {
+        for (int n = 0; n < (int)sizes.size(); n++) {
+            vector<Course> courseList;
+            if (!generateCatalog(shapes[s], sizes[n], seed, courseList)) {
+                cerr << "Unknown shape " << shapes[s] << endl;
+                return 1;
+            }
+
+            vector<string> lookups = generateLookups(courseList, lookupCount, seed);
+
+            for (int b = 0; b < (int)backends.size(); b++) {
+                BenchmarkResult result;
+                result.shape = shapes[s];
+                result.courseCount = sizes[n];
+                if (!measureBackend(backends[b], courseList, lookups, result)) {
+                    cerr << "Unknown backend " << backends[b] << endl;
+                    return 1;
+                }
+
+                // one row per measurement, written as soon as it is known
+                if (format == "csv") {
+                    cout << result.shape << ',' << result.courseCount << ',' << result.backend << ','
+                         << fixed << setprecision(3) << result.loadMs << ',' << result.lookupNs << ',' << result.listMs << ','
+                         << result.memoryBytes << endl;
+                }
+                else {
+                    cout << (first ? "\n" : ",\n") << "  {\"shape\": \"" << result.shape << "\", \"courses\": " << result.courseCount
+                         << ", \"backend\": \"" << result.backend << "\", " << fixed << setprecision(3)
+                         << "\"load_ms\": " << result.loadMs << ", \"lookup_ns\": " << result.lookupNs
+                         << ", \"list_ms\": " << result.listMs << ", \"memory_bytes\": " << result.memoryBytes << "}" << flush;
+                }
+                first = false;
+            }
+        }
+    }
+    if (format == "json") {
+        cout << "\n]" << endl;
+    }
+    return 0;
 }
 
+
+//============================================================================
+// Self-test definitions
+//============================================================================
+
 /*
-Function to check if a file exists in the file structure
-@param: filename as string to validate exisitance
+Function to check the AVL height bound on the worst case for an unbalanced
+tree: one million course IDs inserted one at a time in ascending order.
+An AVL tree of n nodes is never taller than 1.44 log2(n + 2)
+@param: message set when the check fails
+@return: true when the check passes
 */
-bool fileExists(const std::string& filename) {
-    std::ifstream file(filename);
+bool checkSortedInsertHeight(string& failure) {
+    const int COUNT = 1000000;
+    BinarySearchTree tree;
+    for (int i = 0; i < COUNT; i++) {
+        tree.Insert(Course("CSCI" + to_string(1000000 + i), "Course " + to_string(i)));
+    }
 
-    // return true (file exists) or false (file does not exist)
-    return file.good();
+    double limit = 1.44 * log2((double)COUNT + 2);
+    if (tree.Size() != COUNT || tree.Height() > limit) {
+        failure = to_string(tree.Size()) + " courses, height " + to_string(tree.Height()) + ", limit " + to_string(limit);
+        return false;
+    }
+
+    // the in-order walk must still see every course in ascending order
+    int seen = 0;
+    string previous;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (it->courseId <= previous) {
+            failure = it->courseId + " listed after " + previous;
+            return false;
+        }
+        previous = it->courseId;
+        seen += 1;
+    }
+    if (seen != COUNT) {
+        failure = "the walk saw " + to_string(seen) + " of " + to_string(COUNT) + " courses";
+        return false;
+    }
+    return true;
 }
 
 /*
-Function to check if file path is a CSV path
-@param: filename as string to validate as .csv
+Function to check the insert paths that take over a course instead of copying
+it: Insert(Course&&) and Emplace on the tree, and Emplace on the other two
+storages and the catalog. Every course must be found afterwards and a repeated
+ID must be refused. In a -DCOURSE_PLANNER_STATS build a tree insert may also
+make at most one allocation, the slab its node comes from
+@param: message set when the check fails
+@return: true when the check passes
 */
-bool fileCsv(const std::string& filePath) {
-    // check if the file suffix indicates it is a .csv file
-    if (filePath.substr(filePath.length() - 4, 4) != ".csv") {
-
-        // return false it the file does not end with .csv
+bool checkInsertAllocations(string& failure) {
+    const int COUNT = 100000;
+
+    // IDs and names too long to fit inside a string, so any copy would allocate
+    auto courseId = [](int i) { return "COMPUTERSCIENCE" + to_string(1000000 + i); };
+    auto courseName = [](int i) { return "Introduction to course number " + to_string(i); };
+
+    // alternate moved and emplaced courses, counting only the insert itself
+    BinarySearchTree tree;
+    uint64_t most = 0;
+    for (int i = 0; i < COUNT; i++) {
+        Course course(courseId(i), courseName(i));
+        course.prereq.push_back(courseId(i / 2));
+        string id = courseId(i);
+        string name = courseName(i);
+
+        uint64_t allocationsBefore = STATS_THREAD_ALLOCATIONS();
+        bool added = (i % 2 == 0) ? tree.Insert(std::move(course)) : tree.Emplace(std::move(id), std::move(name));
+        most = max(most, STATS_THREAD_ALLOCATIONS() - allocationsBefore);
+        if (!added) {
+            failure = courseId(i) + " was not inserted";
+            return false;
+        }
+    }
+    if (most > 1) {
+        failure = "an insert made " + to_string(most) + " allocations";
+        return false;
+    }
+    if (tree.Insert(Course(courseId(0))) || tree.Emplace(courseId(1)) || tree.Size() != COUNT) {
+        failure = "the tree inserted a repeated ID";
         return false;
     }
+    for (int i = 0; i < COUNT; i++) {
+        const Course* course = tree.Find(courseId(i));
+        if (course == nullptr || course->name != courseName(i) || course->prereq.size() != (size_t)(i % 2 == 0)) {
+            failure = courseId(i) + " was not found as inserted";
+            return false;
+        }
+    }
 
-    // return true if the file does exist with a .csv
+    // the other storages and the catalog take the same constructor arguments
+    const int SMALL_COUNT = 1000;
+    FlatHashStorage hash;
+    SortedVectorStorage sorted;
+    Catalog catalog;
+    for (int i = 0; i < SMALL_COUNT; i++) {
+        if (!hash.Emplace(courseId(i), courseName(i)) || !sorted.Emplace(courseId(i), courseName(i)) || !catalog.Emplace(courseId(i), courseName(i))) {
+            failure = courseId(i) + " was not emplaced";
+            return false;
+        }
+    }
+    if (hash.Emplace(courseId(0)) || sorted.Emplace(courseId(0)) || catalog.Emplace(courseId(0))) {
+        failure = "a storage emplaced a repeated ID";
+        return false;
+    }
+    for (int i = 0; i < SMALL_COUNT; i++) {
+        const Course* found[] = { hash.Find(courseId(i)), sorted.Find(courseId(i)), catalog.Find(courseId(i)) };
+        for (const Course* course : found) {
+            if (course == nullptr || course->name != courseName(i)) {
+                failure = courseId(i) + " was not found as emplaced";
+                return false;
+            }
+        }
+    }
     return true;
 }
 
 /*
-Function to evaluate if a string is convertable to an integer
-@param: filename as string to validate as integer
-Method source: https://stackoverflow.com/a/2845275
+Function to check lookups during reloads: 32 reader threads look up pairs of
+courses while one writer reloads the catalog, switching between two CSV files
+with the same course IDs and different names. Both courses a reader finds
+through one pin must come from the same file, and once the readers stop no
+retired version may be left waiting
+@param: message set when the check fails
+@return: true when the check passes
 */
-inline bool isInteger(const std::string& checkString)
-{
+bool checkConcurrentReload(string& failure) {
+    const int READERS = 32;
+    const int COURSES = 2000;
+    const int RELOADS = 50;
+
+    // two versions of the catalog, every name ends in the letter of its version
+    vector<string> courseIds(COURSES);
+    string csvPaths[2];
+    for (int version = 0; version < 2; version++) {
+        csvPaths[version] = (filesystem::temp_directory_path() / ("course-planner-self-test-" + to_string(version) + ".csv")).string();
+        ofstream csvFile(csvPaths[version], ios::binary);
+        for (int i = 0; i < COURSES; i++) {
+            courseIds[i] = "CSCI" + to_string(100000 + i);
+            csvFile << courseIds[i] << ",Course " << i << ' ' << (char)('A' + version);
+            if (i > 0) {
+                csvFile << ',' << courseIds[i - 1];
+            }
+            csvFile << '\n';
+        }
+        csvFile.close();
+        if (!csvFile) {
+            failure = "could not write " + csvPaths[version];
+            return false;
+        }
+    }
 
-    // if string contains any characters that are non-numerical, return false
-    if (checkString.empty() || ((!isdigit(checkString[0])) && (checkString[0] != '-') && (checkString[0] != '+'))) return false;
+    ConcurrentCatalog catalog;
+    if (!catalog.Reload(csvPaths[0], 1)) {
+        failure = "could not load " + csvPaths[0];
+        return false;
+    }
 
-    // create a character, p, to catch any non-digit character in the input
-    char* checkChar;
+    // readers run until the writer is done
+    atomic<bool> stopping(false);
+    atomic<uint64_t> lookups(0);
+    atomic<uint64_t> missing(0);
+    atomic<uint64_t> mixed(0);
+    vector<thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&, r]() {
+            mt19937 random((uint32_t)r);
+            while (!stopping.load(memory_order_relaxed)) {
+                ConcurrentCatalog::Reader reader = catalog.Read();
+                const Course* first = reader->Find(courseIds[random() % COURSES]);
+                const Course* second = reader->Find(courseIds[random() % COURSES]);
+                if (first == nullptr || second == nullptr) {
+                    missing.fetch_add(1, memory_order_relaxed);
+                }
+                else if (first->name.back() != second->name.back()) {
+                    mixed.fetch_add(1, memory_order_relaxed);
+                }
+                lookups.fetch_add(2, memory_order_relaxed);
+            }
+        });
+    }
 
-    // convert string to long, catching any non-integer values
-    strtol(checkString.c_str(), &checkChar, 10);
+    // the writer reloads, and the retired versions never outnumber the reloads
+    for (int i = 1; i <= RELOADS && failure.empty(); i++) {
+        if (!catalog.Reload(csvPaths[i % 2], 1)) {
+            failure = "reload " + to_string(i) + " failed";
+        }
+        int retired = catalog.RetiredVersions();
+        if (retired > i) {
+            failure = to_string(retired) + " retired versions after " + to_string(i) + " reloads";
+        }
+    }
+    stopping.store(true);
+    for (int r = 0; r < READERS; r++) {
+        readers[r].join();
+    }
+    filesystem::remove(csvPaths[0]);
+    filesystem::remove(csvPaths[1]);
 
-    // return true if no integer values were found; false if at least one was found.
-    return (*checkChar == 0);
+    if (failure.empty() && (missing.load() != 0 || mixed.load() != 0)) {
+        failure = to_string(missing.load()) + " lookups missed and " + to_string(mixed.load()) + " pairs mixed two versions, of "
+            + to_string(lookups.load()) + " lookups";
+    }
+    if (failure.empty() && catalog.RetiredVersions() != 0) {
+        failure = to_string(catalog.RetiredVersions()) + " retired versions left after the readers stopped";
+    }
+    return failure.empty();
 }
 
+/*
+Function for the self-test mode: runs every check, or the ones named, and
+prints one PASS or FAIL line for each
+@param: command line arguments, starting with --self-test
+@return: 0 when every check passed
+*/
+int runSelfTestMode(int argc, char* argv[]) {
+    vector<pair<string, function<bool(string&)>>> checks = {
+        { "avl-sorted-height", checkSortedInsertHeight },
+        { "insert-allocations", checkInsertAllocations },
+        { "concurrent-reload", checkConcurrentReload },
+    };
+
+    // the checks named on the command line, or all of them
+    vector<string> names;
+    for (int i = 2; i < argc; i++) {
+        names.push_back(argv[i]);
+    }
+    for (int i = 0; i < (int)names.size(); i++) {
+        bool known = false;
+        for (int j = 0; j < (int)checks.size(); j++) {
+            known = known || checks[j].first == names[i];
+        }
+        if (!known) {
+            cerr << "Unknown check " << names[i] << endl;
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (int i = 0; i < (int)checks.size(); i++) {
+        if (!names.empty() && find(names.begin(), names.end(), checks[i].first) == names.end()) {
+            continue;
+        }
+        string failure;
+        auto start = chrono::steady_clock::now();
+        bool passed = checks[i].second(failure);
+        cout << (passed ? "PASS " : "FAIL ") << checks[i].first << " (" << fixed << setprecision(1) << elapsedMs(start) << " ms)";
+        if (!passed) {
+            cout << ": " << failure;
+            failed += 1;
+        }
+        cout << endl;
+    }
+    return (failed == 0) ? 0 : 1;
+}
 
-int main()
+int main(int argc, char* argv[])
 {
-    // Define a binary search tree to hold all courses
-    BinarySearchTree* bst;
-    bst = new BinarySearchTree();
+    // --benchmark measures the backends on synthetic catalogs
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        return runBenchmarkMode(argc, argv);
+    }
+
+    // --self-test runs the built-in correctness checks
+    if (argc > 1 && string(argv[1]) == "--self-test") {
+        return runSelfTestMode(argc, argv);
+    }
+
+    // --loadgen sends queries to a running query server
+    if (argc > 1 && string(argv[1]) == "--loadgen") {
+        return runLoadGeneratorMode(argc, argv);
+    }
+
+    // any command line options select batch mode instead of the menu
+    if (argc > 1) {
+        return runBatchMode(argc, argv);
+    }
+
+    // Define a catalog to hold all courses
+    Catalog* catalog;
+    catalog = new Catalog();
     Course course;
 
     // create string for storing path
@@ -605,6 +8811,10 @@ int main()
         std::cout << "     1. Load Data Structure." << endl;
         std::cout << "     2. Print Course List." << endl;
         std::cout << "     3. Print Course." << endl;
+        std::cout << "     4. Print Prerequisite Schedule." << endl;
+        std::cout << "     5. Print All Prerequisites." << endl;
+        std::cout << "     6. Print Courses by Prefix." << endl;
+        std::cout << "     7. Search Course Names." << endl;
         std::cout << "     9. Exit" << endl;
         std::cout << "What would you like to do? ";
         //std::cin >> choice;
@@ -624,7 +8834,7 @@ int main()
         }
 
         // verify that numerical input is an option corelating to the menu
-        if ((choice > 3 && choice != 9) || choice < 1) {
+        if ((choice > 7 && choice != 9) || choice < 1) {
 
             // invalid input message
             cout << choice << " is not a valid option." << endl;
@@ -651,8 +8861,16 @@ int main()
                     break;
                 }
 
-                // load courses from csv
-                loadCourses(filePath, bst);
+                // load courses from csv, or apply only the changes when a catalog is already loaded
+                if (catalog->Size() == 0) {
+                    loadCourses(filePath, catalog);
+                }
+                else {
+                    reloadCourses(filePath, catalog);
+                }
+
+                // lookups dominate after a load, switch them to the frozen index
+                catalog->Freeze();
                 break;
             }
             else {
@@ -666,7 +8884,7 @@ int main()
 
         case 2:
             // print course schedule
-            bst->printSampleSchedule();
+            catalog->printSampleSchedule();
             break;
 
         case 3:
@@ -675,10 +8893,45 @@ int main()
             getline(std::cin, searchId);
 
             // print the course information associated with that search ID
-            bst->printCourseInformation(searchId);
+            catalog->printCourseInformation(searchId);
 
             break;
+
+        case 4:
+            // print a schedule that respects prerequisites
+            catalog->printPrerequisiteSchedule();
+            break;
+
+        case 5:
+            // request course ID to list every prerequisite of
+            cout << "Input course ID to search: ";
+            getline(std::cin, searchId);
+
+            // print every course required before that course
+            catalog->printAllPrerequisites(searchId);
+            break;
+
+        case 6:
+            // request the start of the course IDs to list, such as CSCI3
+            cout << "Input course ID prefix: ";
+            getline(std::cin, searchId);
+
+            // print every course whose ID starts with the prefix
+            catalog->printCoursesWithPrefix(searchId);
+            break;
+
+        case 7:
+            // request words of the course name, such as data structures
+            cout << "Input words to search course names for: ";
+            getline(std::cin, searchId);
+
+            // print every course whose name holds all of the words
+            catalog->printNameSearch(searchId);
+            break;
         }
 
     }
+
+    // free the catalog and all of its courses
+    delete catalog;
 }
\ No newline at end of file